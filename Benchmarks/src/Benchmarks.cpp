@@ -0,0 +1,86 @@
+// Engine benchmarks.  Most benchmarks run from GameInit().  The results are saved, and the application quits, once the
+// benchmarks that need real frames have finished.
+#include <Enterprise/GameEntryPoint.h>
+#include <Enterprise/Runtime.h>
+#include <Enterprise/File.h>
+#include <Enterprise/SceneManager.h>
+#include "Benchmarks.h"
+
+using Enterprise::File;
+using Enterprise::SceneManager;
+
+static std::string results;
+
+void Benchmarks::Report(const std::string& line)
+{
+	EP_INFO("Benchmarks: {}", line);
+	results.append(line).append("\n");
+}
+
+static void finish()
+	// Helper function: saves the benchmark results and quits.
+{
+	File::ErrorCode ec = File::SaveTextFile("d/BenchmarkResults.txt", results);
+	if (ec != File::ErrorCode::Success)
+	{
+		EP_ERROR("Benchmarks: Could not save \"d/BenchmarkResults.txt\".  Error: {}", File::ErrorCodeToStr(ec));
+	}
+	Enterprise::Runtime::Quit();
+}
+
+static bool (*const frameBenchmarks[])() =
+{
+	Benchmarks::StepPostStressBenchmark,
+	Benchmarks::StepOverloadBenchmark,
+};
+static size_t currentFrameBenchmark = 0;
+
+static void stepFrameBenchmarks()
+	// Helper function: steps the current frame-based benchmark, and finishes once the last one is done.
+{
+	constexpr size_t frameBenchmarkCount = sizeof(frameBenchmarks) / sizeof(frameBenchmarks[0]);
+	if (currentFrameBenchmark < frameBenchmarkCount && frameBenchmarks[currentFrameBenchmark]())
+	{
+		currentFrameBenchmark++;
+		if (currentFrameBenchmark == frameBenchmarkCount)
+		{
+			finish();
+		}
+	}
+}
+
+void GameSysInit()
+{
+}
+
+void GameSysCleanup()
+{
+}
+
+void GameInit()
+{
+#ifndef EP_CONFIG_RELEASE
+	Benchmarks::Report("WARNING: Assertions are enabled in this build.  Use the Release configuration for timings.");
+#endif
+
+	Benchmarks::RunEntityIndexBenchmark();
+	Benchmarks::RunEntityStressBenchmark();
+	Benchmarks::RunSnapshotBenchmark();
+	Benchmarks::RunDispatchBenchmark();
+	Benchmarks::RunPayloadDispatchBenchmark();
+
+	Benchmarks::RegisterOverloadBenchmark();
+	SceneManager::RegisterUpdateFn(stepFrameBenchmarks, "Benchmarks");
+}
+
+void GameCleanup()
+{
+}
+
+void PieInit()
+{
+}
+
+void PieCleanup()
+{
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <Enterprise/Core.h>
+
+namespace Benchmarks
+{
+
+/// Measures wall-clock time from construction.
+class Timer
+{
+public:
+	Timer() : m_start(std::chrono::steady_clock::now()) {}
+
+	/// Get the time elapsed since construction.
+	/// @return The elapsed time in milliseconds.
+	double ElapsedMs() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point m_start;
+};
+
+/// Add a line to the benchmark results.
+/// @param line The text of the line.
+/// @remarks Results are logged to the console, and saved to "d/BenchmarkResults.txt" once every benchmark has run.
+void Report(const std::string& line);
+
+/// Compare std::map and SparseSet entity indices: insertion, lookup, and deletion.
+void RunEntityIndexBenchmark();
+/// Spawn and delete a million entities through SceneManager, then churn a tenth of them for several rounds.
+/// @remarks Needs a "SpawnedIDRange" of at least a million, which Benchmarks.epproj sets.
+void RunEntityStressBenchmark();
+
+/// Take and restore a whole-scene snapshot every 240 Hz fixed step, for several scene sizes.
+void RunSnapshotBenchmark();
+
+/// Time event subscription, dispatch, and unsubscription with 1, 10, and 100 subscribers.
+/// @remarks Dispatch is timed by HashName, by EventSlot, and through a typed Channel.
+void RunDispatchBenchmark();
+/// Compare dispatching a payload by HashName or EventSlot, unpacked with Unpack() in each callback, against dispatching
+/// the same payload through a typed Channel.
+void RunPayloadDispatchBenchmark();
+
+// Benchmarks that need real frames are stepped once per frame, from Update(), one after another.  Each step function
+// returns true once its benchmark is done.
+
+/// Post events from eight threads at once, checking that every event is delivered in the order each thread posted it.
+/// @remarks Reports the cost of each Post() and the throughput of posting and delivery.
+bool StepPostStressBenchmark();
+
+/// Register the FixedUpdate() used by the overload benchmark.
+/// @remarks Systems cannot be registered while systems are running, so this is called from GameInit().
+void RegisterOverloadBenchmark();
+/// Run frames with FixedUpdate() slower than real time, under each fixed timestep catch-up policy.
+bool StepOverloadBenchmark();
+
+}
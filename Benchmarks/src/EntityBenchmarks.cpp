@@ -0,0 +1,152 @@
+#include <map>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <Enterprise/SceneManager.h>
+#include "Benchmarks.h"
+
+using Enterprise::SceneManager;
+using Enterprise::SparseSet;
+
+static constexpr size_t IndexBenchmarkEntities = 100000;
+static constexpr size_t IndexBenchmarkLookupPasses = 10;
+static constexpr size_t StressBenchmarkEntities = 1000000;
+static constexpr size_t StressBenchmarkChurnRounds = 10;
+
+template <typename InsertFn, typename LookupFn, typename EraseFn>
+static void timeEntityIndex(const char* name, const std::vector<EntityID>& ids,
+	const std::vector<EntityID>& lookupOrder, InsertFn insert, LookupFn lookup, EraseFn erase)
+	// Helper function: times insertion, lookup, and deletion of every ID in one container, and reports the results.
+{
+	Benchmarks::Timer insertTimer;
+	for (EntityID id : ids)
+	{
+		insert(id);
+	}
+	double insertMs = insertTimer.ElapsedMs();
+
+	uint64_t checksum = 0;
+	Benchmarks::Timer lookupTimer;
+	for (size_t pass = 0; pass < IndexBenchmarkLookupPasses; pass++)
+	{
+		for (EntityID id : lookupOrder)
+		{
+			checksum += lookup(id);
+		}
+	}
+	double lookupMs = lookupTimer.ElapsedMs();
+
+	Benchmarks::Timer eraseTimer;
+	for (EntityID id : lookupOrder)
+	{
+		erase(id);
+	}
+	double eraseMs = eraseTimer.ElapsedMs();
+
+	double lookups = double(lookupOrder.size() * IndexBenchmarkLookupPasses);
+	Benchmarks::Report(fmt::format("  {:<10} create {:8.3f} ms  lookup {:7.2f} ns/op  delete {:8.3f} ms  (checksum {})",
+		name, insertMs, lookupMs * 1.0e6 / lookups, eraseMs, checksum));
+}
+
+void Benchmarks::RunEntityIndexBenchmark()
+{
+	Report(fmt::format("Entity index: {} entities, {} random-order lookup passes", IndexBenchmarkEntities,
+		IndexBenchmarkLookupPasses));
+
+	std::vector<EntityID> ids(IndexBenchmarkEntities);
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		ids[i] = EntityID_Make(uint32_t(i + 1), 1);
+	}
+	std::vector<EntityID> lookupOrder = ids;
+	std::shuffle(lookupOrder.begin(), lookupOrder.end(), std::mt19937_64(42));
+
+	std::map<EntityID, HashName> map;
+	timeEntityIndex("std::map", ids, lookupOrder,
+		[&](EntityID id) { map.emplace(id, HashName(id)); },
+		[&](EntityID id) { return map.find(id)->second; },
+		[&](EntityID id) { map.erase(id); });
+
+	SparseSet<HashName> sparseSet;
+	timeEntityIndex("SparseSet", ids, lookupOrder,
+		[&](EntityID id) { sparseSet.Insert(id, HashName(id)); },
+		[&](EntityID id) { return sparseSet.Get(id); },
+		[&](EntityID id) { sparseSet.Erase(id); });
+}
+
+static size_t spawnStressEntities(EntityID* outEntities, size_t count, HashName name)
+	// Helper function: spawns entities into an array, and returns the number spawned before the range ran out.
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		outEntities[i] = SceneManager::CreateEntity(name, glm::vec3(float(i % 1000), float(i / 1000), 0.0f));
+		if (outEntities[i] == 0)
+			return i;
+	}
+	return count;
+}
+
+void Benchmarks::RunEntityStressBenchmark()
+{
+	Report(fmt::format("Entity stress: {} spawned entities, {} churn rounds of 10%", StressBenchmarkEntities,
+		StressBenchmarkChurnRounds));
+	if (SceneManager::GetSpawnedIDRange() < StressBenchmarkEntities)
+	{
+		Report(fmt::format("  Skipped: \"SpawnedIDRange\" is {}.  Run with \"-p Benchmarks/Benchmarks.epproj\".",
+			SceneManager::GetSpawnedIDRange()));
+		return;
+	}
+
+	HashName name = HN("StressEntity");
+	std::vector<EntityID> entities(StressBenchmarkEntities);
+
+	Timer spawnTimer;
+	size_t spawned = spawnStressEntities(entities.data(), entities.size(), name);
+	double spawnMs = spawnTimer.ElapsedMs();
+
+	Timer deleteTimer;
+	SceneManager::DeleteEntities(entities.data(), spawned);
+	double deleteMs = deleteTimer.ElapsedMs();
+
+	// Every slot is recycled, so every old ID must now be stale
+	std::vector<EntityID> oldEntities(entities.begin(), entities.begin() + spawned);
+	Timer respawnTimer;
+	size_t respawned = spawnStressEntities(entities.data(), entities.size(), name);
+	double respawnMs = respawnTimer.ElapsedMs();
+	size_t staleValid = std::count_if(oldEntities.begin(), oldEntities.end(), SceneManager::IsEntityValid);
+
+	Report(fmt::format("  spawn     {:9.3f} ms  {:6.1f} ns/entity  ({} spawned)", spawnMs,
+		spawnMs * 1.0e6 / double(std::max<size_t>(spawned, 1)), spawned));
+	Report(fmt::format("  delete    {:9.3f} ms  {:6.1f} ns/entity  (one batch)", deleteMs,
+		deleteMs * 1.0e6 / double(std::max<size_t>(spawned, 1))));
+	Report(fmt::format("  respawn   {:9.3f} ms  {:6.1f} ns/entity  ({} spawned, {} stale IDs still valid)", respawnMs,
+		respawnMs * 1.0e6 / double(std::max<size_t>(respawned, 1)), respawned, staleValid));
+
+	// Churn: delete a random tenth of the entities one at a time, then spawn replacements
+	std::mt19937_64 rng(42);
+	double churnDeleteMs = 0.0, churnSpawnMs = 0.0;
+	size_t churnCount = respawned / 10;
+	for (size_t round = 0; round < StressBenchmarkChurnRounds; round++)
+	{
+		for (size_t i = 0; i < churnCount; i++)
+		{
+			std::swap(entities[i], entities[i + rng() % (respawned - i)]);
+		}
+
+		Timer churnDeleteTimer;
+		for (size_t i = 0; i < churnCount; i++)
+		{
+			SceneManager::DeleteEntity(entities[i]);
+		}
+		churnDeleteMs += churnDeleteTimer.ElapsedMs();
+
+		Timer churnSpawnTimer;
+		spawnStressEntities(entities.data(), churnCount, name);
+		churnSpawnMs += churnSpawnTimer.ElapsedMs();
+	}
+	double churnOps = double(std::max<size_t>(churnCount * StressBenchmarkChurnRounds, 1));
+	Report(fmt::format("  churn     delete {:6.1f} ns/entity  spawn {:6.1f} ns/entity",
+		churnDeleteMs * 1.0e6 / churnOps, churnSpawnMs * 1.0e6 / churnOps));
+
+	SceneManager::PurgeSpawnedEntities();
+}
@@ -0,0 +1,335 @@
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <Enterprise/Events.h>
+#include "Benchmarks.h"
+
+using Enterprise::Events;
+
+static constexpr size_t DispatchBenchmarkCallbackCalls = 10000000;
+
+static uint64_t callbackCalls = 0;
+
+// Each subscriber needs its own function, since subscribing a callback twice is not supported
+template <size_t N>
+static bool eventCallback(Events::Event&)
+{
+	callbackCalls++;
+	return false;
+}
+
+template <typename T, size_t N>
+static bool channelCallback(const T& data)
+{
+	callbackCalls += data.value;
+	return false;
+}
+
+template <size_t Count>
+struct BenchmarkPayload
+{
+	uint64_t value;
+};
+
+template <size_t... Ns>
+static constexpr std::array<Events::EventCallbackPtr, sizeof...(Ns)> makeEventCallbacks(std::index_sequence<Ns...>)
+{
+	return { eventCallback<Ns>... };
+}
+
+template <typename T, size_t... Ns>
+static constexpr std::array<typename Events::Channel<T>::CallbackPtr, sizeof...(Ns)>
+	makeChannelCallbacks(std::index_sequence<Ns...>)
+{
+	return { channelCallback<T, Ns>... };
+}
+
+template <size_t Count>
+static void timeDispatch()
+	// Helper function: times Subscribe(), Dispatch(), and Unsubscribe() with a number of subscribers, and reports the
+	// results.  A fresh event type and channel are used for each subscriber count.
+{
+	constexpr size_t dispatches = DispatchBenchmarkCallbackCalls / Count;
+	auto eventCallbacks = makeEventCallbacks(std::make_index_sequence<Count>());
+	auto channelCallbacks = makeChannelCallbacks<BenchmarkPayload<Count>>(std::make_index_sequence<Count>());
+	HashName type = HN(fmt::format("DispatchBenchmark{}", Count));
+	Events::EventSlot slot = Events::GetEventSlot(type);
+	callbackCalls = 0;
+
+	Benchmarks::Timer subscribeTimer;
+	for (Events::EventCallbackPtr callback : eventCallbacks)
+	{
+		Events::Subscribe(type, callback);
+	}
+	double subscribeMs = subscribeTimer.ElapsedMs();
+	for (auto callback : channelCallbacks)
+	{
+		Events::Channel<BenchmarkPayload<Count>>::Subscribe(callback);
+	}
+
+	Benchmarks::Timer hashNameTimer;
+	for (size_t i = 0; i < dispatches; i++)
+	{
+		Events::Dispatch(type);
+	}
+	double hashNameMs = hashNameTimer.ElapsedMs();
+
+	Benchmarks::Timer slotTimer;
+	for (size_t i = 0; i < dispatches; i++)
+	{
+		Events::Dispatch(slot);
+	}
+	double slotMs = slotTimer.ElapsedMs();
+
+	Benchmarks::Timer channelTimer;
+	for (size_t i = 0; i < dispatches; i++)
+	{
+		Events::Channel<BenchmarkPayload<Count>>::Dispatch({ 1 });
+	}
+	double channelMs = channelTimer.ElapsedMs();
+
+	Benchmarks::Timer unsubscribeTimer;
+	for (Events::EventCallbackPtr callback : eventCallbacks)
+	{
+		Events::Unsubscribe(type, callback);
+	}
+	double unsubscribeMs = unsubscribeTimer.ElapsedMs();
+	for (auto callback : channelCallbacks)
+	{
+		Events::Channel<BenchmarkPayload<Count>>::Unsubscribe(callback);
+	}
+
+	double nsPerDispatch = 1.0e6 / double(dispatches);
+	Benchmarks::Report(fmt::format("  {:>3} subscribers  subscribe {:7.1f} ns  unsubscribe {:7.1f} ns  (per callback)",
+		Count, subscribeMs * 1.0e6 / double(Count), unsubscribeMs * 1.0e6 / double(Count)));
+	Benchmarks::Report(fmt::format("{:19}dispatch  HashName {:8.1f} ns  EventSlot {:8.1f} ns  Channel {:8.1f} ns",
+		"", hashNameMs * nsPerDispatch, slotMs * nsPerDispatch, channelMs * nsPerDispatch));
+	if (callbackCalls != dispatches * Count * 3)
+	{
+		Benchmarks::Report(fmt::format("{:19}FAILED: {} callbacks were invoked, expected {}.", "", callbackCalls,
+			dispatches * Count * 3));
+	}
+}
+
+void Benchmarks::RunDispatchBenchmark()
+{
+	Report(fmt::format("Event dispatch: {} callback calls per dispatch method", DispatchBenchmarkCallbackCalls));
+	timeDispatch<1>();
+	timeDispatch<10>();
+	timeDispatch<100>();
+}
+
+// The payload of a data event is copied into a DataEvent when dispatched by HashName or EventSlot, and each callback
+// unpacks it.  A channel passes a reference to the caller's payload straight to each callback.
+template <size_t Count>
+struct UnpackPayload
+{
+	uint64_t value;
+	uint64_t extra[3];
+};
+
+template <typename T, size_t N>
+static bool unpackCallback(Events::Event& e)
+{
+	callbackCalls += Events::Unpack<T>(e).value;
+	return false;
+}
+
+template <typename T, size_t... Ns>
+static constexpr std::array<Events::EventCallbackPtr, sizeof...(Ns)> makeUnpackCallbacks(std::index_sequence<Ns...>)
+{
+	return { unpackCallback<T, Ns>... };
+}
+
+template <size_t Count>
+static void timePayloadDispatch()
+	// Helper function: times dispatching a payload to a number of subscribers, unpacked from a data event and through a
+	// channel, and reports the results.
+{
+	using Payload = UnpackPayload<Count>;
+	constexpr size_t dispatches = DispatchBenchmarkCallbackCalls / Count;
+	auto unpackCallbacks = makeUnpackCallbacks<Payload>(std::make_index_sequence<Count>());
+	auto channelCallbacks = makeChannelCallbacks<Payload>(std::make_index_sequence<Count>());
+	HashName type = HN(fmt::format("PayloadDispatchBenchmark{}", Count));
+	Events::EventSlot slot = Events::GetEventSlot(type);
+	callbackCalls = 0;
+
+	for (Events::EventCallbackPtr callback : unpackCallbacks)
+	{
+		Events::Subscribe(type, callback);
+	}
+	for (auto callback : channelCallbacks)
+	{
+		Events::Channel<Payload>::Subscribe(callback);
+	}
+
+	Benchmarks::Timer hashNameTimer;
+	for (size_t i = 0; i < dispatches; i++)
+	{
+		Events::Dispatch(type, Payload{ 1, { i, i, i } });
+	}
+	double hashNameMs = hashNameTimer.ElapsedMs();
+
+	Benchmarks::Timer slotTimer;
+	for (size_t i = 0; i < dispatches; i++)
+	{
+		Events::Dispatch(slot, Payload{ 1, { i, i, i } });
+	}
+	double slotMs = slotTimer.ElapsedMs();
+
+	Benchmarks::Timer channelTimer;
+	for (size_t i = 0; i < dispatches; i++)
+	{
+		Events::Channel<Payload>::Dispatch({ 1, { i, i, i } });
+	}
+	double channelMs = channelTimer.ElapsedMs();
+
+	for (Events::EventCallbackPtr callback : unpackCallbacks)
+	{
+		Events::Unsubscribe(type, callback);
+	}
+	for (auto callback : channelCallbacks)
+	{
+		Events::Channel<Payload>::Unsubscribe(callback);
+	}
+
+	double nsPerDispatch = 1.0e6 / double(dispatches);
+	Benchmarks::Report(fmt::format("  {:>3} subscribers  Unpack() by HashName {:8.1f} ns  by EventSlot {:8.1f} ns  "
+		"Channel {:8.1f} ns", Count, hashNameMs * nsPerDispatch, slotMs * nsPerDispatch, channelMs * nsPerDispatch));
+	if (callbackCalls != dispatches * Count * 3)
+	{
+		Benchmarks::Report(fmt::format("{:19}FAILED: {} callbacks were invoked, expected {}.", "", callbackCalls,
+			dispatches * Count * 3));
+	}
+}
+
+void Benchmarks::RunPayloadDispatchBenchmark()
+{
+	Report(fmt::format("Payload dispatch: {} callback calls per dispatch method, {}-byte payload",
+		DispatchBenchmarkCallbackCalls, sizeof(UnpackPayload<1>)));
+	timePayloadDispatch<1>();
+	timePayloadDispatch<10>();
+	timePayloadDispatch<100>();
+}
+
+namespace
+{
+struct PostStressEvent
+{
+	uint32_t producer;
+	uint32_t sequence;
+};
+}
+static constexpr uint32_t PostStressProducers = 8;
+static constexpr uint32_t PostStressEventsPerProducer = 200000;
+static constexpr uint64_t PostStressEvents = uint64_t(PostStressProducers) * PostStressEventsPerProducer;
+static constexpr unsigned int PostStressTimeoutFrames = 60; // Frames to wait for stragglers once posting is done
+
+static bool postStressStarted = false;
+static std::vector<std::thread> postStressThreads;
+static std::atomic<bool> postStressGo = false;
+static std::atomic<uint32_t> postStressFinished = 0;
+static std::array<double, PostStressProducers> postStressPostMs; // Each producer's time spent posting
+static std::vector<uint32_t> postStressNextSequences; // The sequence number expected next from each producer
+static uint64_t postStressReceived = 0, postStressMisordered = 0;
+static Benchmarks::Timer postStressTimer;
+static double postStressDeliveredMs = 0.0;
+static unsigned int postStressWaitFrames = 0;
+
+static void checkPostStressBatch(const PostStressEvent* data, size_t count)
+	// Helper function: checks that each producer's events arrive in the order it posted them.
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t& expected = postStressNextSequences[data[i].producer];
+		if (data[i].sequence != expected)
+		{
+			postStressMisordered++;
+		}
+		expected = data[i].sequence + 1;
+	}
+	postStressReceived += count;
+	if (postStressReceived == PostStressEvents)
+	{
+		postStressDeliveredMs = postStressTimer.ElapsedMs();
+	}
+}
+
+static void startPostStress()
+	// Helper function: starts every producer at once.  Delivery happens at each frame's sync point while they post,
+	// so every part of Post() is contended.
+{
+	postStressNextSequences.assign(PostStressProducers, 0);
+	Events::Channel<PostStressEvent>::SubscribeBatch(checkPostStressBatch);
+
+	for (uint32_t producer = 0; producer < PostStressProducers; producer++)
+	{
+		postStressThreads.emplace_back([producer]()
+		{
+			while (!postStressGo.load(std::memory_order_acquire));
+			Benchmarks::Timer postTimer;
+			for (uint32_t sequence = 0; sequence < PostStressEventsPerProducer; sequence++)
+			{
+				Events::Channel<PostStressEvent>::Post({ producer, sequence });
+			}
+			postStressPostMs[producer] = postTimer.ElapsedMs();
+			postStressFinished.fetch_add(1, std::memory_order_release);
+		});
+	}
+
+	postStressTimer = Benchmarks::Timer();
+	postStressGo.store(true, std::memory_order_release);
+}
+
+bool Benchmarks::StepPostStressBenchmark()
+{
+	if (!postStressStarted)
+	{
+		postStressStarted = true;
+		Report(fmt::format("Post() stress: {} producer threads posting {} events each", PostStressProducers,
+			PostStressEventsPerProducer));
+		startPostStress();
+		return false;
+	}
+
+	if (postStressFinished.load(std::memory_order_acquire) < PostStressProducers)
+		return false;
+	if (postStressReceived < PostStressEvents && ++postStressWaitFrames < PostStressTimeoutFrames)
+		return false;
+
+	for (std::thread& producer : postStressThreads)
+	{
+		producer.join();
+	}
+	postStressThreads.clear();
+	Events::Channel<PostStressEvent>::UnsubscribeBatch(checkPostStressBatch);
+
+	double postMs = 0.0, slowestPostMs = 0.0;
+	for (double ms : postStressPostMs)
+	{
+		postMs += ms;
+		slowestPostMs = std::max(slowestPostMs, ms);
+	}
+	Report(fmt::format("  Post()    {:7.1f} ns per call  {:6.2f} M events/s across all threads",
+		postMs * 1.0e6 / double(PostStressEvents), double(PostStressEvents) / (slowestPostMs * 1000.0)));
+
+	bool passed = postStressReceived == PostStressEvents && postStressMisordered == 0;
+	for (uint32_t next : postStressNextSequences)
+	{
+		passed &= next == PostStressEventsPerProducer;
+	}
+	if (passed)
+	{
+		Report(fmt::format("  delivered {:7.1f} ms to the last sync point  {:6.2f} M events/s, all in order",
+			postStressDeliveredMs, double(PostStressEvents) / (postStressDeliveredMs * 1000.0)));
+	}
+	else
+	{
+		Report(fmt::format("  FAILED: Received {} of {} events, {} out of order.", postStressReceived,
+			PostStressEvents, postStressMisordered));
+	}
+	return true;
+}
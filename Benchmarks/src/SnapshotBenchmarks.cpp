@@ -0,0 +1,86 @@
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <Enterprise/SceneManager.h>
+#include "Benchmarks.h"
+
+using Enterprise::SceneManager;
+
+static constexpr size_t SnapshotBenchmarkSceneSizes[] = { 1000, 10000, 100000 };
+static constexpr size_t SnapshotBenchmarkSteps = 240; // One second of fixed updates
+static constexpr size_t SnapshotBenchmarkRingSize = 8;
+static constexpr double SnapshotBenchmarkBudgetMs = 1000.0 / 240.0;
+
+static void timeSnapshots(size_t entityCount)
+	// Helper function: snapshots a scene every fixed step for one second, then restores each snapshot.
+{
+	HashName name = HN("SnapshotEntity");
+	std::vector<EntityID> entities(entityCount);
+	for (size_t i = 0; i < entityCount; i++)
+	{
+		entities[i] = SceneManager::CreateEntity(name, glm::vec3(float(i % 1000), float(i / 1000), 0.0f));
+	}
+
+	// Rollback netcode keeps a short ring of recent states
+	std::array<SceneManager::Snapshot, SnapshotBenchmarkRingSize> ring;
+	Benchmarks::Timer firstTimer;
+	bool ok = SceneManager::TakeSnapshot(ring[0]);
+	double firstMs = firstTimer.ElapsedMs();
+
+	double takeMs = 0.0, takeMaxMs = 0.0;
+	for (size_t step = 0; step < SnapshotBenchmarkSteps; step++)
+	{
+		// Move a sixteenth of the entities, as a simulation step would
+		for (size_t i = step % 16; i < entityCount; i += 16)
+		{
+			SceneManager::SetEntityPosition(entities[i], glm::vec3(float(step), float(i), 0.0f));
+		}
+
+		Benchmarks::Timer takeTimer;
+		ok &= SceneManager::TakeSnapshot(ring[step % SnapshotBenchmarkRingSize]);
+		double ms = takeTimer.ElapsedMs();
+		takeMs += ms;
+		takeMaxMs = std::max(takeMaxMs, ms);
+	}
+
+	double restoreMs = 0.0, restoreMaxMs = 0.0;
+	for (size_t step = 0; step < SnapshotBenchmarkSteps; step++)
+	{
+		Benchmarks::Timer restoreTimer;
+		ok &= SceneManager::RestoreSnapshot(ring[step % SnapshotBenchmarkRingSize]);
+		double ms = restoreTimer.ElapsedMs();
+		restoreMs += ms;
+		restoreMaxMs = std::max(restoreMaxMs, ms);
+	}
+
+	takeMs /= double(SnapshotBenchmarkSteps);
+	restoreMs /= double(SnapshotBenchmarkSteps);
+	Benchmarks::Report(fmt::format("  {:>6} entities  {:8.1f} KiB  first take {:7.3f} ms", entityCount,
+		double(ring[0].Size()) / 1024.0, firstMs));
+	Benchmarks::Report(fmt::format("{:19}take    avg {:7.3f} ms  max {:7.3f} ms  ({:5.1f}% of a 240 Hz step)", "",
+		takeMs, takeMaxMs, takeMs * 100.0 / SnapshotBenchmarkBudgetMs));
+	Benchmarks::Report(fmt::format("{:19}restore avg {:7.3f} ms  max {:7.3f} ms  ({:5.1f}% of a 240 Hz step)", "",
+		restoreMs, restoreMaxMs, restoreMs * 100.0 / SnapshotBenchmarkBudgetMs));
+	if (!ok)
+	{
+		Benchmarks::Report("                   FAILED: a snapshot could not be taken or restored.");
+	}
+
+	SceneManager::PurgeSpawnedEntities();
+}
+
+void Benchmarks::RunSnapshotBenchmark()
+{
+	Report(fmt::format("Snapshots: take and restore every step of {} steps at 240 Hz, ring of {}",
+		SnapshotBenchmarkSteps, SnapshotBenchmarkRingSize));
+	for (size_t entityCount : SnapshotBenchmarkSceneSizes)
+	{
+		if (entityCount > SceneManager::GetSpawnedIDRange())
+		{
+			Report(fmt::format("  {:>6} entities  Skipped: \"SpawnedIDRange\" is {}.", entityCount,
+				SceneManager::GetSpawnedIDRange()));
+			continue;
+		}
+		timeSnapshots(entityCount);
+	}
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <Enterprise/Time.h>
+#include <Enterprise/SceneManager.h>
+#include "Benchmarks.h"
+
+using Enterprise::Time;
+using Enterprise::FixedCatchUpPolicy;
+using Enterprise::SceneManager;
+namespace TimeConstants = Enterprise::Constants::Time;
+
+static constexpr unsigned int OverloadWarmupFrames = 10;
+static constexpr double OverloadPhaseSeconds = 3.0;
+
+// Each phase runs real frames with a FixedUpdate() that busy-waits for a set cost.  A 240 Hz step has 4.17 ms of real
+// time, so steps costing more than that can never catch up.
+struct OverloadPhase
+{
+	const char* name;
+	double fixedUpdateCostMs;
+	FixedCatchUpPolicy policy;
+	unsigned int maxSubsteps;
+	bool variableTimestep;
+};
+static constexpr OverloadPhase overloadPhases[] =
+{
+	{ "Drop, light load",           1.0, FixedCatchUpPolicy::Drop,      TimeConstants::DefaultMaxFixedSubsteps, false },
+	{ "Drop, overloaded",           6.0, FixedCatchUpPolicy::Drop,      TimeConstants::DefaultMaxFixedSubsteps, false },
+	{ "Drop, overloaded, 4 steps",  6.0, FixedCatchUpPolicy::Drop,      4,                                      false },
+	{ "CarryOver, overloaded",      6.0, FixedCatchUpPolicy::CarryOver, TimeConstants::DefaultMaxFixedSubsteps, false },
+	{ "Variable step, overloaded",  6.0, FixedCatchUpPolicy::Drop,      TimeConstants::DefaultMaxFixedSubsteps, true  },
+};
+static constexpr size_t overloadPhaseCount = sizeof(overloadPhases) / sizeof(overloadPhases[0]);
+
+static size_t currentPhase = overloadPhaseCount;
+static unsigned int warmupFramesLeft = 0;
+static bool measuring = false;
+static uint64_t startFrame;
+static double startRealTime, startGameTime;
+static Time::FixedUpdateStats startStats;
+static double maxTimeDebt;
+
+static void beginPhase(size_t phase)
+	// Helper function: applies the settings of an overload phase.
+{
+	currentPhase = phase;
+	warmupFramesLeft = OverloadWarmupFrames;
+	measuring = false;
+
+	if (phase < overloadPhaseCount)
+	{
+		Time::SetFixedCatchUpPolicy(overloadPhases[phase].policy);
+		Time::SetMaxFixedSubsteps(overloadPhases[phase].maxSubsteps);
+		Time::SetVariableFixedTimestep(overloadPhases[phase].variableTimestep);
+	}
+	else
+	{
+		Time::SetFixedCatchUpPolicy(FixedCatchUpPolicy::Drop);
+		Time::SetMaxFixedSubsteps(TimeConstants::DefaultMaxFixedSubsteps);
+		Time::SetVariableFixedTimestep(false);
+	}
+}
+
+static void overloadFixedUpdate()
+	// Helper function: burns the current phase's fixed update cost.
+{
+	if (currentPhase >= overloadPhaseCount)
+		return;
+
+	Benchmarks::Timer timer;
+	while (timer.ElapsedMs() < overloadPhases[currentPhase].fixedUpdateCostMs) {}
+}
+
+void Benchmarks::RegisterOverloadBenchmark()
+{
+	SceneManager::RegisterFixedUpdateFn(overloadFixedUpdate, "OverloadBenchmark");
+}
+
+bool Benchmarks::StepOverloadBenchmark()
+{
+	static bool started = false;
+	if (!started)
+	{
+		started = true;
+		Report(fmt::format("Fixed update overload: {:.0f} s per phase, 240 Hz steps have {:.2f} ms of real time",
+			OverloadPhaseSeconds, TimeConstants::FixedTimestep * 1000.0));
+		beginPhase(0);
+		return false;
+	}
+
+	Time::FixedUpdateStats stats = Time::GetFixedUpdateStats();
+	if (warmupFramesLeft > 0)
+	{
+		warmupFramesLeft--;
+		return false;
+	}
+	if (!measuring)
+	{
+		measuring = true;
+		startFrame = Time::FrameCount();
+		startRealTime = Time::RealTime();
+		startGameTime = Time::GameTime();
+		startStats = stats;
+		maxTimeDebt = stats.timeDebt;
+		return false;
+	}
+
+	maxTimeDebt = std::max(maxTimeDebt, stats.timeDebt);
+	double realSeconds = double(Time::RealTime()) - startRealTime;
+	if (realSeconds < OverloadPhaseSeconds)
+		return false;
+
+	double frames = double(Time::FrameCount() - startFrame);
+	double gameSeconds = double(Time::GameTime()) - startGameTime;
+	Report(fmt::format("  {:<26} frame {:6.2f} ms  steps/frame {:5.2f}  game/real {:4.2f}  "
+		"throttled {:5.1f}%", overloadPhases[currentPhase].name, realSeconds * 1000.0 / frames,
+		double(stats.totalSteps - startStats.totalSteps) / frames, gameSeconds / realSeconds,
+		double(stats.throttledFrames - startStats.throttledFrames) * 100.0 / frames));
+	Report(fmt::format("{:28}dropped {:6.3f} s  max debt {:6.3f} s  final step {:5.2f} ms", "",
+		stats.droppedGameTime - startStats.droppedGameTime, maxTimeDebt, stats.fixedTimestep * 1000.0));
+
+	beginPhase(currentPhase + 1);
+	return currentPhase >= overloadPhaseCount;
+}
@@ -68,21 +68,25 @@ LRESULT CALLBACK Win32_WinProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lP
 		break;
 
 	case WM_CHAR:
-		Events::Dispatch(HN("KeyChar"), char(wParam));
+	{
+		static const Events::EventSlot keyCharSlot = Events::GetEventSlot(HN("KeyChar"));
+		Events::Dispatch(keyCharSlot, char(wParam));
 		break;
-
+	}
 	case WM_MOUSEMOVE:
 	{
+		static const Events::EventSlot mousePositionSlot = Events::GetEventSlot(HN("MousePosition"));
 		ImGuiIO io = ImGui::GetIO();
 		if (io.WantCaptureMouse)
 		{
-			Events::Dispatch(HN("MousePosition"),
+			Events::Dispatch(mousePositionSlot,
 				glm::vec2(GET_X_LPARAM(lParam), io.DisplaySize.x - GET_Y_LPARAM(lParam)));
 		}
 		break;
 	}
 	case WM_INPUT: // Raw Input API
 	{
+		static const Events::EventSlot rawInputSlot = Events::GetEventSlot(HN("Win32_RawInput"));
 		UINT RIDataSize = sizeof(RAWINPUT);
 		BYTE RIData[sizeof(RAWINPUT)];
 
@@ -94,13 +98,13 @@ LRESULT CALLBACK Win32_WinProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lP
 		{
 			ImGuiIO io = ImGui::GetIO();
 			if(!io.WantCaptureKeyboard)
-				Events::Dispatch(HN("Win32_RawInput"), (RAWINPUT*)RIData);
+				Events::Dispatch(rawInputSlot, (RAWINPUT*)RIData);
 		}
 		else if (reinterpret_cast<RAWINPUT*>(RIData)->header.dwType == RIM_TYPEMOUSE)
 		{
 			ImGuiIO io = ImGui::GetIO();
 			if(!io.WantCaptureMouse)
-				Events::Dispatch(HN("Win32_RawInput"), (RAWINPUT*)RIData);
+				Events::Dispatch(rawInputSlot, (RAWINPUT*)RIData);
 		}
 
 		return DefWindowProc(hWnd, message, wParam, lParam);
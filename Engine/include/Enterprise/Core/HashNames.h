@@ -5,6 +5,7 @@
 /// The hashed version of a string name.  Used throughout Enterprise.
 typedef uint64_t HashName;
 /// A HashName literal.  Can be used in compile-time situations, but is not subject to collision detection.
+/// @remarks To declare a named HashName constant that is checked for collisions, use HN_CONSTANT().
 constexpr uint64_t operator ""_HN(const char* stringname, size_t len)
 {
 	return CTSpookyHash::Hash64(stringname, len, 0);
@@ -16,6 +17,7 @@ constexpr uint64_t operator ""_HN(const char* stringname, size_t len)
 /// @param stringname The C string to convert.
 /// @param length The number of characters in @c stringname.
 /// @return The string's associated HashName.
+/// @remarks In Debug builds, HN() and HN_ToStr() may be called from any thread.
 EP_API HashName HN(const char* stringname, size_t length);
 
 /// Convert a C string into a HashName.  Performs collision checks in Debug builds.
@@ -35,6 +37,34 @@ EP_API HashName HN(std::string stringname);
 /// just returns the hash if invoked in Dev or Release builds.
 EP_API std::string HN_ToStr(HashName hashname);
 
+/// Save every string hashed so far, with its HashName, to a text file.
+/// @param nativePath The native path of the file.
+/// @return @c true if the file was saved.
+/// @remarks Each line holds a HashName in hexadecimal, a tab, and the string.  Tools can use the file to turn the
+/// HashNames in Dev and Release logs and profiles back into strings.  Only available in Debug builds.  Games can
+/// also save the table on exit with the @c --hashname-table command line option.
+EP_API bool HN_SaveTable(const std::string& nativePath);
+
+/// @cond DOXYGEN_SKIP
+// Registers the string of a HN_CONSTANT() during static initialization.  Always returns true.
+EP_API bool HN_RegisterStatic(const char* stringname, size_t length);
+// Reports collisions between HN_CONSTANT()s found during static initialization, once logging is available.
+EP_API void HN_CheckStaticRegistry();
+/// @endcond
+
+/// Declare a HashName constant, which is computed at compile time in every build configuration.
+/// @param name The name of the constant.
+/// @param stringname The string literal to hash.
+/// @remarks In Debug builds, the string is registered for collision detection and HN_ToStr() during static
+/// initialization, so using the constant costs no more than using an integer.  Prefer it over HN() for names used
+/// every frame, as in:
+/// @code HN_CONSTANT(spriteTypeName, "Sprite"); @endcode
+/// @note Declare constants at namespace scope.  At function scope, they are registered when the function first
+/// runs.
+#define HN_CONSTANT(name, stringname) \
+	constexpr HashName name = operator ""_HN(stringname, sizeof(stringname) - 1); \
+	[[maybe_unused]] static const bool name##_registered = HN_RegisterStatic(stringname, sizeof(stringname) - 1)
+
 #else // EP_CONFIG_DEV, EP_CONFIG_RELEASE
 
 /// Convert a C string into a HashName.  Performs collision checks in Debug builds.
@@ -72,7 +102,19 @@ inline std::string HN_ToStr(HashName hashname)
 	return std::to_string(hashname);
 }
 
+/// Declare a HashName constant, which is computed at compile time in every build configuration.
+/// @param name The name of the constant.
+/// @param stringname The string literal to hash.
+/// @remarks In Debug builds, the string is registered for collision detection and HN_ToStr() during static
+/// initialization, so using the constant costs no more than using an integer.  Prefer it over HN() for names used
+/// every frame, as in:
+/// @code HN_CONSTANT(spriteTypeName, "Sprite"); @endcode
+/// @note Declare constants at namespace scope.  At function scope, they are registered when the function first
+/// runs.
+#define HN_CONSTANT(name, stringname) \
+	constexpr HashName name = operator ""_HN(stringname, sizeof(stringname) - 1)
+
 #endif
 
 /// A null HashName.  Equivalent to HashName of empty string.
-#define HN_NULL HN("")
+#define HN_NULL (""_HN)
@@ -1,18 +1,49 @@
 #pragma once
 #include <unordered_map>
 #include <initializer_list>
-#include <list>
+#include <vector>
+#include <atomic>
+#include <string>
+#include <cstring>
+#include <type_traits>
 #include "Enterprise/Core.h"
 #include "Enterprise/StateManager.h"
 
 namespace Enterprise
 {
 
+/// @cond DOXYGEN_SKIP
+// Hashes the name of a type, as spelled out in this function's signature.  Only used through Events::TypeID.
+template <typename T>
+constexpr HashName typeNameHash()
+{
+#ifdef _MSC_VER
+	return CTSpookyHash::Hash64(__FUNCSIG__, sizeof(__FUNCSIG__) - 1, 0);
+#else
+	return CTSpookyHash::Hash64(__PRETTY_FUNCTION__, sizeof(__PRETTY_FUNCTION__) - 1, 0);
+#endif
+}
+/// @endcond
+
 /// The Enterprise events system.
 /// @see @ref Events
 class Events
 {
+	struct ChannelData;
+	struct PostNodeBase
+	{
+		PostNodeBase* next;
+	};
+
 public:
+
+	/// A compile-time identifier for a type.
+	/// @tparam T The type to identify.
+	/// @remarks A hash of the type's name, which is the same in every module.  Used in place of RTTI to identify event
+	/// payload types.
+	/// @remarks A constant, so reading it never hashes the name at run time.
+	template <typename T>
+	static constexpr HashName TypeID = typeNameHash<T>();
 	
 	/// An Enterprise event.
 	class EP_API Event
@@ -20,17 +51,25 @@ public:
 	public:
 		/// Constructor.
 		/// @param type This event's type.
-		Event(HashName type) : m_type(type) {}
+		Event(HashName type) : m_type(type), m_dataType(0) {}
 
 		/// Get this event's type.
 		/// @return This event's type.
 		inline const HashName Type() { return m_type; }
 		
 		Event() = delete;
-		virtual ~Event() {}
+
+	protected:
+		/// Constructor for events with a data payload.
+		/// @param type This event's type.
+		/// @param dataType The TypeID of the data payload.
+		Event(HashName type, HashName dataType) : m_type(type), m_dataType(dataType) {}
 
 	private:
+		friend class Events;
+
 		HashName m_type;
+		HashName m_dataType; // 0 for events without a payload
 	};
 	
 	
@@ -43,7 +82,7 @@ public:
 		/// Constructor.
 		/// @param type This event's type.
 		/// @param data The data payload.
-		DataEvent(HashName type, T data) : Event(type), m_data(data) {}
+		DataEvent(HashName type, T data) : Event(type, TypeID<T>), m_data(std::move(data)) {}
 
 		/// Get this event's data payload.
 		/// @return The data payload.
@@ -79,6 +118,8 @@ public:
 	
 	/// Dispatch a pre-made event.
 	/// @param e A reference to the event to dispatch.
+	/// @warning Dispatch functions may only be called from the main thread.  Other threads should use
+	/// Channel::Post().
 	EP_API static void Dispatch(Event& e);
 
 	/// Dispatch a new event of the given type.
@@ -93,19 +134,49 @@ public:
 	static void Dispatch(HashName type, T data)
 	{
 		// Generate the event
-		Events::DataEvent<T> e = {type, data};
-		
-		// Call each registered callback until one returns true
-		for (auto callbackit = callbackPtrs[type].rbegin();
-			 callbackit != callbackPtrs[type].rend();
-			 ++callbackit)
-		{
-			std::weak_ptr<StateManager::State> prevActiveState = StateManager::activeState;
-			StateManager::activeState = callbackit->second;
-			bool willBreak = callbackit->first(e);
-			StateManager::activeState = prevActiveState;
-			if (willBreak) break;
-		}
+		Events::DataEvent<T> e = {type, std::move(data)};
+		Dispatch(e);
+	}
+
+
+	/// A pre-resolved event type.  Dispatching through a slot skips the subscriber lookup.
+	/// @remarks Useful for event types dispatched many times per frame, such as input and window events.  Slots stay
+	/// valid for the lifetime of the application.
+	class EventSlot
+	{
+	public:
+		/// Get the event type of this slot.
+		/// @return The HashName of the event type.
+		inline HashName Type() const { return m_type; }
+
+	private:
+		friend class Events;
+		EventSlot(HashName type, ChannelData* data) : m_type(type), m_data(data) {}
+
+		HashName m_type;
+		ChannelData* m_data;
+	};
+
+	/// Get the slot of an event type.
+	/// @param type The HashName of the event type.
+	/// @return The slot, which can be stored and passed to Dispatch() in place of the HashName.
+	EP_API static EventSlot GetEventSlot(HashName type);
+
+	/// Dispatch a new event through a pre-resolved slot.
+	/// @param slot The slot of the desired event type.
+	EP_API static void Dispatch(EventSlot slot);
+
+	/// Dispatch a new event with a data payload through a pre-resolved slot.
+	/// @tparam T Type of the data payload.
+	/// @param slot The slot of the desired event type.
+	/// @param data The data payload.
+	template <typename T>
+	static void Dispatch(EventSlot slot, T data)
+	{
+		Events::DataEvent<T> e = {slot.m_type, std::move(data)};
+		if (traceState != TraceState::Off && !traceEvent(e))
+			return;
+		dispatchToSubscribers(*slot.m_data, e);
 	}
 
 
@@ -115,19 +186,371 @@ public:
 	/// @return The data payload.
 	/// @note C++17's structured bindings are useful for extracting data from tuples, as in:
 	/// @code auto[x, y] \= Events\::Unpack&lt;std\::pair&lt;int, int&gt;&gt;(e); @endcode
+	/// @warning The payload type is only checked when assertions are enabled.  In Release builds, unpacking an event
+	/// as the wrong type is undefined behavior.  Use TryUnpack() for events whose payload type is not known.
 	template <typename T>
 	static T& Unpack(Enterprise::Events::Event& e) 
 	{
-		Enterprise::Events::DataEvent<T>* converted = dynamic_cast<Enterprise::Events::DataEvent<T>*>(&e);
-		EP_ASSERTF(converted, "Events: Unpack() cannot cast event to requested DataEvent type.");
-		return converted->Data();
+		EP_ASSERTF(e.m_dataType == TypeID<T>, "Events: Unpack() cannot cast event to requested DataEvent type.");
+		return static_cast<Enterprise::Events::DataEvent<T>&>(e).Data();
 	}
 
+	/// Extract the data payload from a DataEvent, if it has the requested type.
+	/// @tparam T The type of the data payload.
+	/// @param e Reference to the event to unpack.
+	/// @return A pointer to the data payload, or @c nullptr if the event has no payload of type @c T.
+	/// @remarks Unlike Unpack(), the payload type is checked in every build configuration.
+	template <typename T>
+	static T* TryUnpack(Enterprise::Events::Event& e)
+	{
+		if (e.m_dataType != TypeID<T>)
+			return nullptr;
+		return &static_cast<Enterprise::Events::DataEvent<T>&>(e).Data();
+	}
+
+
+	/// Allow the data payloads of a type to be stored in event traces.
+	/// @tparam T The type of the data payload.  Must be trivially copyable.
+	/// @remarks Payloads of unregistered types are recorded without their data, and are skipped on replay.
+	/// @warning Do not register types containing pointers or handles.  Their values are meaningless when replayed.
+	template <typename T>
+	static void RegisterTraceType()
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Events: Trace payload types must be trivially copyable.");
+		registerTraceType(TypeID<T>, sizeof(T), &tracePayload<T>, &replayTracedEvent<T>);
+	}
+
+	/// Start recording every dispatched event to a trace file.
+	/// @param path The virtual path of the trace file.  It is written when recording stops.
+	/// @return @c true if recording started.
+	/// @remarks Each event is stamped with the frame number and fixed timestep count at which it was dispatched, and
+	/// the length and fixed timestep of each frame are recorded as well.  Recording stops automatically on exit.
+	/// Recording can also be started with the @c --record-trace command line option.
+	EP_API static bool StartTraceRecording(const std::string& path);
+	/// Stop recording events and write the trace file.
+	/// @return @c true if the trace file was written.  @c false if no trace was being recorded, or if saving failed.
+	EP_API static bool StopTraceRecording();
+
+	/// Replay a recorded event trace.
+	/// @param path The virtual path of the trace file.
+	/// @param quitWhenFinished Whether to quit the application once the last recorded frame has been replayed.
+	/// @return @c true if the trace was loaded and replay started.
+	/// @remarks Events which reached the game from outside the frame, such as window and input events, are
+	/// dispatched again at the start of the frame that followed them in the recording.  While replaying, live events
+	/// from outside the frame are ignored, except for @c QuitRequested.  Each replayed frame has the length and fixed
+	/// timestep of its recorded counterpart, so the same number of fixed updates are simulated.  Replay can also be
+	/// started with the @c --replay-trace command line option, which quits when the trace is finished.
+	EP_API static bool StartTraceReplay(const std::string& path, bool quitWhenFinished = false);
+	/// Check whether an event trace is being replayed.
+	/// @return @c true if a trace is being replayed.
+	EP_API static bool IsReplayingTrace();
+
+
+	/// The points in each frame at which posted events are delivered.
+	enum class SyncPoint
+	{
+		AfterFixedUpdate,	// After each FixedUpdate()
+		AfterUpdate,		// After Update()
+		BeforeDraw			// After PreDraw(), before the frame is drawn
+	};
+
+	/// A typed event channel.  An alternative to HashName event types for frequent events.
+	/// @tparam T The type of the data payload.  Each payload type has exactly one channel.
+	/// @remarks Callbacks receive the payload directly by const reference, so no Event object is constructed and no
+	/// unpacking is needed.  Subscribers are kept in a contiguous array, which is found once per module by the
+	/// payload type's TypeID.
+	/// @remarks Like HashName events, the most recently subscribed callback is invoked first, and a callback returning
+	/// @c true stops propagation.
+	/// @note Use a dedicated payload type for each kind of event, as in:
+	/// @code struct EnemyDefeated { EntityID enemy; };  Events::Channel<EnemyDefeated>::Dispatch({ id }); @endcode
+	template <typename T>
+	class Channel
+	{
+	public:
+		/// A pointer to a channel callback function.
+		typedef bool(*CallbackPtr)(const T& data);
+		/// A pointer to a batch callback function, which receives every event posted since the last flush.
+		typedef void(*BatchCallbackPtr)(const T* data, size_t count);
+
+		/// Register a callback for this channel.
+		/// @param callback A pointer to the callback function.
+		/// @return @c callback.  Useful for tracking the callback address when it is a lambda expression.
+		static CallbackPtr Subscribe(CallbackPtr callback)
+		{
+			Events::subscribeChannel(channelData().subscribers, reinterpret_cast<ErasedCallbackPtr>(callback));
+			return callback;
+		}
+
+		/// Unregister a callback from this channel.
+		/// @param callback The pointer to the callback function.
+		static void Unsubscribe(CallbackPtr callback)
+		{
+			Events::unsubscribeChannel(channelData(), channelData().subscribers,
+				reinterpret_cast<ErasedCallbackPtr>(callback));
+		}
+
+		/// Register a callback for batches of posted events.
+		/// @param callback A pointer to the batch callback function.
+		/// @return @c callback.  Useful for tracking the callback address when it is a lambda expression.
+		/// @remarks Batch callbacks only receive events sent with Post().  Events sent with Dispatch() are not seen.
+		static BatchCallbackPtr SubscribeBatch(BatchCallbackPtr callback)
+		{
+			Events::subscribeChannel(channelData().batchSubscribers, reinterpret_cast<ErasedCallbackPtr>(callback));
+			return callback;
+		}
+
+		/// Unregister a batch callback from this channel.
+		/// @param callback The pointer to the batch callback function.
+		static void UnsubscribeBatch(BatchCallbackPtr callback)
+		{
+			Events::unsubscribeChannel(channelData(), channelData().batchSubscribers,
+				reinterpret_cast<ErasedCallbackPtr>(callback));
+		}
+
+		/// Dispatch an event on this channel immediately.
+		/// @param data The data payload.
+		static void Dispatch(const T& data)
+		{
+			ChannelData& channel = channelData();
+			channel.dispatchDepth++;
+
+			// Indexed from the back, so that callbacks may subscribe and unsubscribe during dispatch
+			for (size_t i = channel.subscribers.size(); i-- > 0; )
+			{
+				CallbackPtr callback = reinterpret_cast<CallbackPtr>(channel.subscribers[i].callback);
+				if (!callback)
+					continue; // Unsubscribed during this dispatch
+
+				bool willBreak;
+				if (sameState(channel.subscribers[i].state, StateManager::activeState))
+				{
+					willBreak = callback(data);
+				}
+				else
+				{
+					std::weak_ptr<StateManager::State> prevActiveState = StateManager::activeState;
+					StateManager::activeState = channel.subscribers[i].state;
+					willBreak = callback(data);
+					StateManager::activeState = prevActiveState;
+				}
+				if (willBreak) break;
+			}
+
+			channel.dispatchDepth--;
+			if (channel.dispatchDepth == 0 && channel.hasRemovals)
+			{
+				Events::compactChannel(channel);
+			}
+		}
+
+		/// Queue an event on this channel, to be delivered on the main thread at the channel's sync point.
+		/// @param data The data payload, which is copied into the queue.
+		/// @remarks At the sync point, each batch callback receives every queued event at once, and then each event is
+		/// dispatched to the regular callbacks.  Events posted while the queue is being delivered are held until the
+		/// next sync point.
+		/// @remarks Post() is lock-free and may be called from any thread.  Events posted by one thread are delivered
+		/// in the order that thread posted them.  Events from different threads are interleaved in the order their
+		/// posts completed.
+		static void Post(const T& data)
+		{
+			ChannelData& channel = channelData();
+			channel.deliverFn.store(deliverPosted, std::memory_order_relaxed);
+
+			PostNode* node = new PostNode{ { channel.postHead.load(std::memory_order_relaxed) }, data };
+			while (!channel.postHead.compare_exchange_weak(node->next, node,
+				std::memory_order_release, std::memory_order_relaxed));
+
+			if (!channel.isQueued.exchange(true, std::memory_order_acq_rel))
+			{
+				Events::queueChannel(channel);
+			}
+		}
+
+		/// Set when events posted to this channel are delivered.
+		/// @param point The sync point.  The default is SyncPoint::AfterUpdate.
+		/// @warning Set the sync point before any events are posted to the channel.
+		static void SetSyncPoint(SyncPoint point)
+		{
+			EP_ASSERTF(!channelData().isQueued,
+				"Events: A channel's sync point cannot be changed while events are queued on it.");
+			channelData().syncPoint = point;
+		}
+
+	private:
+		struct PostNode : PostNodeBase
+		{
+			T data;
+		};
+
+		static ChannelData& channelData()
+		{
+			static ChannelData* data = &Events::getChannel(TypeID<T>);
+			return *data;
+		}
+
+		static void deliverPosted(ChannelData& channel)
+		{
+			// Delivered events are moved into a contiguous buffer, which is kept for reuse
+			if (!channel.deliveryBuffer)
+			{
+				channel.deliveryBuffer = new std::vector<T>;
+			}
+			std::vector<T>& delivering = *static_cast<std::vector<T>*>(channel.deliveryBuffer);
+
+			// Take every posted event at once.  The list is newest first, so it is reversed into posting order.
+			PostNodeBase* node = channel.postHead.exchange(nullptr, std::memory_order_acquire);
+			while (node)
+			{
+				PostNode* posted = static_cast<PostNode*>(node);
+				delivering.push_back(std::move(posted->data));
+				node = node->next;
+				delete posted;
+			}
+			if (delivering.empty())
+				return;
+			std::reverse(delivering.begin(), delivering.end());
+
+			channel.dispatchDepth++;
+
+			for (size_t i = channel.batchSubscribers.size(); i-- > 0; )
+			{
+				BatchCallbackPtr callback = reinterpret_cast<BatchCallbackPtr>(channel.batchSubscribers[i].callback);
+				if (!callback)
+					continue;
+
+				if (sameState(channel.batchSubscribers[i].state, StateManager::activeState))
+				{
+					callback(delivering.data(), delivering.size());
+				}
+				else
+				{
+					std::weak_ptr<StateManager::State> prevActiveState = StateManager::activeState;
+					StateManager::activeState = channel.batchSubscribers[i].state;
+					callback(delivering.data(), delivering.size());
+					StateManager::activeState = prevActiveState;
+				}
+			}
+			if (!channel.subscribers.empty())
+			{
+				for (const T& data : delivering)
+				{
+					Dispatch(data);
+				}
+			}
+
+			channel.dispatchDepth--;
+			if (channel.dispatchDepth == 0 && channel.hasRemovals)
+			{
+				Events::compactChannel(channel);
+			}
+			delivering.clear();
+		}
+	};
+
 	
 private:
+	friend class Runtime;
+	friend class Input;
+
+	typedef void(*ErasedCallbackPtr)();
+	struct ChannelSubscriber
+	{
+		ErasedCallbackPtr callback; // nullptr if removed during dispatch
+		std::weak_ptr<StateManager::State> state;
+	};
+	struct ChannelData
+	{
+		std::vector<ChannelSubscriber> subscribers;
+		std::vector<ChannelSubscriber> batchSubscribers;
+		unsigned int dispatchDepth = 0;
+		bool hasRemovals = false;
+
+		// Posted events form a lock-free stack, newest first, which the main thread empties at the sync point
+		std::atomic<PostNodeBase*> postHead = nullptr;
+		std::atomic<void(*)(ChannelData&)> deliverFn = nullptr; // Channel<T>::deliverPosted
+		std::atomic<bool> isQueued = false; // Awaiting delivery at syncPoint
+		ChannelData* nextQueued = nullptr;
+		SyncPoint syncPoint = SyncPoint::AfterUpdate;
+		void* deliveryBuffer = nullptr; // A std::vector<T>, created on the main thread and kept until exit
+	};
+
+	// Compares the states owning two handles without touching reference counts.
+	static inline bool sameState(const std::weak_ptr<StateManager::State>& a,
+		const std::weak_ptr<StateManager::State>& b)
+	{
+		return !a.owner_before(b) && !b.owner_before(a);
+	}
+
+	EP_API static ChannelData& getChannel(HashName typeID);
+	EP_API static void subscribeChannel(std::vector<ChannelSubscriber>& list, ErasedCallbackPtr callback);
+	EP_API static void unsubscribeChannel(ChannelData& channel, std::vector<ChannelSubscriber>& list,
+		ErasedCallbackPtr callback);
+	EP_API static void compactChannel(ChannelData& channel);
+	EP_API static void queueChannel(ChannelData& channel);
+	EP_API static void dispatchToSubscribers(ChannelData& subscribers, Event& e);
+
+	static void DeliverPosted(SyncPoint point);
+
+	enum class TraceState
+	{
+		Off,
+		Recording,
+		Replaying
+	};
+	typedef const void*(*TracePayloadFn)(Event& e);
+	typedef void(*TraceReplayFn)(HashName type, const uint8_t* data);
+	struct TraceTypeInfo
+	{
+		size_t size;
+		TracePayloadFn payloadFn;
+		TraceReplayFn replayFn;
+	};
+
+	template <typename T>
+	static const void* tracePayload(Event& e)
+	{
+		return &static_cast<DataEvent<T>&>(e).Data();
+	}
+	template <typename T>
+	static void replayTracedEvent(HashName type, const uint8_t* data)
+	{
+		// Trivially copyable types need not be default constructible, so the payload is copied into raw storage
+		alignas(T) uint8_t payload[sizeof(T)];
+		std::memcpy(payload, data, sizeof(T));
+		DataEvent<T> e = {type, *reinterpret_cast<T*>(payload)};
+		Dispatch(e);
+	}
+
+	// Records state polled during the frame, such as gamepad input, as an event from before the frame.  Replays
+	// dispatch it at the start of the frame, so the polling system can apply it in place of polling.
+	template <typename T>
+	static void tracePolledState(HashName type, const T& data)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Events: Trace payload types must be trivially copyable.");
+		if (traceState == TraceState::Recording)
+		{
+			DataEvent<T> e = {type, data};
+			tracePolledEvent(e);
+		}
+	}
+
+	EP_API static void registerTraceType(HashName dataType, size_t size, TracePayloadFn payloadFn,
+		TraceReplayFn replayFn);
+	EP_API static bool traceEvent(Event& e);
+	EP_API static void tracePolledEvent(Event& e);
+	// Events of the type are not recorded, and are still blocked during replays.  For platform events whose effects
+	// are recorded by tracePolledState().
+	EP_API static void excludeFromTrace(HashName type);
+	static void BeginTraceFrame();
+	static void EndTraceFrame();
+	static EP_API TraceState traceState;
+	static std::unordered_map<HashName, TraceTypeInfo> traceTypes; // Key is the TypeID of the payload type
+	static std::atomic<ChannelData*> queuedChannels[3]; // Lock-free stacks of channels with posted events
 
-	// Key is the HashName of the event type.  State pointer is address of active state.
-	static EP_API std::unordered_map<HashName, std::list<std::pair<Events::EventCallbackPtr, std::weak_ptr<StateManager::State>>>> callbackPtrs;
+	// Key is the TypeID of the payload type.  Node-based, so references cached by Channel<T> stay valid.
+	static EP_API std::unordered_map<HashName, ChannelData> channels;
+	// Key is the HashName of the event type.  Node-based, so EventSlots stay valid.
+	static EP_API std::unordered_map<HashName, ChannelData> eventTypes;
 
 };
 
@@ -76,6 +76,13 @@ public:
 	/// @remarks This method can be used to dump a fully-formed text file from memory to a text file.
 	/// To write discontiguous text to file, use TextFileWriter.
 	EP_API static ErrorCode SaveTextFile(const std::string& path, const std::string& inString);
+	/// Save a block of memory to a binary file.
+	/// @param path The virtual path of the binary file.
+	/// @param data Pointer to the data to save.
+	/// @param size The number of bytes to save.
+	/// @return The result of the file save operation.
+	/// @note This function will replace any file that already exists at 'path'.
+	EP_API static ErrorCode SaveBinaryFile(const std::string& path, const void* data, size_t size);
 
 	/// A helper class for streaming data from text files.
 	/// To use it, create a class instance, open a file with Open() and get each line of text with GetLine().
@@ -169,6 +176,54 @@ public:
 	};
 
 
+	/// A read-only view of a file's contents, mapped directly into memory.
+	/// To use it, create a class instance, open a file with Open() and read the contents through Data().
+	/// @remarks Mapping avoids copying the file into a separate buffer, and pages are only read from disk as they are
+	/// touched.  The mapped contents remain valid until the file is closed.
+	class MappedFile
+	{
+	public:
+		MappedFile() {};
+		/// Optionally open a file during object construction.
+		/// @param path The virtual path of the file.
+		/// @note To confirm the file was opened successfully, use GetLastError().
+		MappedFile(const std::string& path) { m_errorcode = Open(path); }
+		~MappedFile() { Close(); }
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/// Map a new file.
+		/// @param path The virtual path of the file.
+		/// @return Result of the file open operation.
+		/// @note If a file is already mapped, this method will automatically close it.
+		EP_API ErrorCode Open(const std::string& path);
+		/// Get the result of the last file open operation.
+		/// @return The result of the last file open operation.
+		inline ErrorCode GetLastError() { return m_errorcode; }
+		/// Unmap the currently open file.
+		/// @note This method is invoked automatically by ~MappedFile().
+		/// @note It is safe to invoke this method even when no file is open.
+		EP_API void Close();
+
+		/// Get the mapped file contents.
+		/// @return Pointer to the first byte of the file, or @c nullptr if no file is open or the file is empty.
+		inline const uint8_t* Data() const { return m_data; }
+		/// Get the size of the mapped file.
+		/// @return The size of the file in bytes.
+		inline size_t Size() const { return m_size; }
+
+	private:
+		std::string m_path;
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+		ErrorCode m_errorcode = ErrorCode::Null;
+#ifdef _WIN32
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+#endif
+	};
+
+
 	/// A helper class for reading data from INI files.
 	/// To use it, create a class instance, load a file with Load() and use the Get methods to obtain values.
 	class INIReader
@@ -274,6 +274,10 @@ public:
 	/// @return The HashName of the path which was used to load this texture.
 	EP_API static HashName GetTextureHashedPath(TextureHandle texture);
 
+	/// Increment the reference count for a texture.
+	/// @param texture The handle of the texture.
+	/// @remarks Each call must be balanced by a call to DeleteTexture().
+	EP_API static void RetainTexture(TextureHandle texture);
 	/// Decrement the reference count for a texture.
 	/// @param texture The handle of the texture.
 	/// @note If the reference count for a texture reaches 0, it is deleted from GPU memory.
@@ -117,6 +117,20 @@ private:
 	static std::vector<GamePadBuffer> gpBuffer;
 	static bool currentBuffer; // used as index to double-buffered raw input
 
+	// Raw input state of one frame, stored in event traces in place of platform input events.  Only the first
+	// MaxTracedGamepads gamepads are recorded.
+	static constexpr size_t MaxTracedGamepads = 4;
+	struct TracedInputFrame
+	{
+		uint64_t keys[2];
+		float mouseAxes[KBMouseBuffer::numOfMouseAxes];
+		uint16_t gamepadButtons[MaxTracedGamepads];
+		float gamepadAxes[MaxTracedGamepads][GamePadBuffer::numOfGamepadAxes];
+		uint32_t gamepadCount;
+	};
+	static TracedInputFrame replayedInputFrame;
+	static bool hasReplayedInputFrame;
+
 	// Context stuff
 
 	struct ActionMapping
@@ -151,6 +165,8 @@ private:
 
 	static bool HandlePlatformEvents(Events::Event& e);
 	static void GetRawInput();
+	static void TraceRawInput();
+	static void ApplyReplayedRawInput();
 	static void CheckForControllerWake();
 	static StreamID UnbindController(ControllerID controller);
 	static void ProcessContext(Context& context);
@@ -1,24 +1,41 @@
 #pragma once
+#include <typeindex>
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 #include <yaml-cpp/yaml.h>
 #include "Enterprise/Core.h"
-
-/// A unique identifier for a scene entity.
-typedef uint64_t EntityID;
+#include "Enterprise/SceneManager/SparseSet.h"
+#include "Enterprise/SceneManager/EntityCommandBuffer.h"
 
 namespace Enterprise
 {
 
 namespace Constants
 {
-///// The maximum number of entities allowed in the scene simultaneously.
-//extern const size_t MaxEntities;
-///// The maximum number of entities that can be spawned at runtime.
-//extern const size_t MaxSpawnedEntities;
-
-constexpr size_t MaxEntities = 3000;
-const size_t MaxSpawnedEntities = 500;
+/// The default number of entities to preallocate storage for.
+/// @remarks Projects can override this with the @c SceneManager/EntityCapacity key in their project file.  The entity
+/// pool grows past this capacity in chunks when needed.
+constexpr size_t DefaultEntityCapacity = 3000;
+/// The default size of the spawned EntityID range.
+/// @remarks Projects can override this with the @c SceneManager/SpawnedIDRange key in their project file.  Slot
+/// indices in [1, SpawnedIDRange] belong to spawned entities, so scene file entities must use IDs above this range.
+constexpr size_t DefaultSpawnedIDRange = 500;
+/// The default time budget for incremental scene loading, in microseconds per frame.
+/// @remarks Projects can override this with the @c SceneManager/SceneLoadBudget key in their project file.
+constexpr unsigned int DefaultSceneLoadBudget = 2000;
+/// The default edge length of the cells in SceneManager's spatial index, in world units.
+/// @remarks Projects can override this with the @c SceneManager/SpatialCellSize key in their project file.  Cells
+/// should be about the size of a typical query radius.
+constexpr float DefaultSpatialCellSize = 10.0f;
+/// The number of frames of removal history kept for change queries.
+/// @remarks Removals older than this are discarded, so systems which skip more frames than this between change queries
+/// should fall back to processing everything.  See SceneManager::GetOldestTrackedTick().
+constexpr size_t ChangeHistoryFrames = 120;
+/// The number of most recent invocations of each system included in its timing statistics.
+constexpr size_t SystemTimingWindow = 300;
+/// The default number of frames between automatic dumps of system timing statistics.
+/// @remarks Projects can override this with the @c SceneManager/SystemTimingDumpInterval key in their project file.
+constexpr unsigned int DefaultSystemTimingDumpInterval = 600;
 }
 
 /// Enterprise's global entity system.
@@ -30,12 +47,30 @@ public:
 
 	/// A pointer to a component deletion callback.  Deletes all components of a type from an entity.
 	typedef void (*DelComponentFn)(EntityID entity);
+	/// A pointer to a batch component deletion callback.  Deletes all components of a type from many entities.
+	/// IDs of entities without a component of the type should be ignored.
+	typedef void (*BatchDelComponentFn)(const EntityID* entities, size_t count);
 	/// A pointer to a component query callback.  Returns all EntityIDs with a component type attached.
 	typedef std::vector<EntityID>(*QueryComponentFn)();
+	/// A pointer to a component check callback.  Returns whether an entity has a component type attached.
+	typedef bool (*HasComponentFn)(EntityID entity);
 	/// A pointer to a text serialization callback for a component type.
 	typedef bool (*TextSerializeFn)(EntityID entity, YAML::Node& yamlOut);
 	/// A pointer to a text deserialization callback for a component type.
 	typedef bool (*TextDeserializeFn)(EntityID entity, const YAML::Node& yamlIn);
+	/// A pointer to a binary serialization callback for a component type.  Appends the component's data to @c outData.
+	typedef bool (*BinarySerializeFn)(EntityID entity, std::vector<uint8_t>& outData);
+	/// A pointer to a binary deserialization callback for a component type.
+	typedef bool (*BinaryDeserializeFn)(EntityID entity, const uint8_t* data, size_t size);
+	/// A pointer to a snapshot callback for a component type.  Appends the state of every component of the type to
+	/// @c outData.
+	typedef void (*SaveSnapshotFn)(std::vector<uint8_t>& outData);
+	/// A pointer to a snapshot restore callback for a component type.  Replaces every component of the type with the
+	/// state written by the type's SaveSnapshotFn.
+	typedef void (*RestoreSnapshotFn)(const uint8_t* data, size_t size);
+	/// A pointer to a snapshot release callback for a component type.  Releases any resources, such as GPU handles,
+	/// that the type's SaveSnapshotFn retained for the snapshot.
+	typedef void (*ReleaseSnapshotFn)(const uint8_t* data, size_t size);
 
 	/// Register a new component type with SceneManager.
 	/// @param name The HashName of the new component type.
@@ -47,46 +82,312 @@ public:
 		DelComponentFn dcf, QueryComponentFn qcf,
 		TextSerializeFn tsf, TextDeserializeFn tdf);
 
+	/// Register a batch deletion callback for a component type.
+	/// @param name The HashName of the component type.  Must already be registered with RegisterComponentType().
+	/// @param bdcf Pointer to the batch delete function for this component type.
+	/// @remarks Batch deleters are optional.  When entities are deleted, SceneManager calls the batch deleter once
+	/// with the whole batch instead of calling the type's DelComponentFn once per entity, so the type can compact its
+	/// storage in a single pass.
+	EP_API static void RegisterBatchDeleter(HashName name, BatchDelComponentFn bdcf);
+
+	/// Register a component check callback for a component type.
+	/// @param name The HashName of the component type.  Must already be registered with RegisterComponentType().
+	/// @param hcf Pointer to the component check function for this component type.
+	/// @remarks Check callbacks are optional.  ApplyCommandBuffers() uses them to reject components added to entities
+	/// that already have one.  Without one, the type's QueryComponentFn is searched instead, which is much slower.
+	EP_API static void RegisterComponentCheck(HashName name, HasComponentFn hcf);
+
+	/// Register binary serialization callbacks for a component type.
+	/// @param name The HashName of the component type.  Must already be registered with RegisterComponentType().
+	/// @param bsf Pointer to the binary serialization function for this component type.
+	/// @param bdf Pointer to the binary deserialization function for this component type.
+	/// @remarks Binary callbacks are optional.  Component types without them are stored as YAML in binary scenes.
+	EP_API static void RegisterBinarySerializers(HashName name, BinarySerializeFn bsf, BinaryDeserializeFn bdf);
+
+	/// Register snapshot callbacks for a component type.
+	/// @param name The HashName of the component type.  Must already be registered with RegisterComponentType().
+	/// @param ssf Pointer to the snapshot function for this component type.
+	/// @param rsf Pointer to the snapshot restore function for this component type.
+	/// @param relsf Pointer to the snapshot release function for this component type.  Optional.
+	/// @remarks Snapshot callbacks are optional.  Component types without them are snapshotted through their text
+	/// serialization callbacks, which is much slower.
+	/// @remarks Component types holding reference-counted resources should retain them in @c ssf and release them in
+	/// @c relsf, so that the resources survive until the snapshot is discarded.  @c rsf must release the resources
+	/// held by the components it replaces, and retain those of the components it restores.
+	EP_API static void RegisterSnapshotFns(HashName name,
+		SaveSnapshotFn ssf, RestoreSnapshotFn rsf, ReleaseSnapshotFn relsf = nullptr);
+
+	/// Allow a component type to be deserialized on a worker thread.
+	/// @param name The HashName of the component type.  Must already be registered with RegisterComponentType().
+	/// @remarks When parallel deserialization is enabled, each allowed component type in a scene is deserialized on
+	/// its own worker thread while the remaining types are deserialized on the main thread.
+	/// @warning Only allow this if the type's TextDeserializeFn touches nothing but its own component storage.  It
+	/// must not call Graphics functions or dispatch events.  HN() is safe to call.
+	EP_API static void AllowParallelDeserialization(HashName name);
+	/// Enable or disable parallel deserialization of component types.
+	/// @param enabled Whether component types allowed by AllowParallelDeserialization() are deserialized in parallel.
+	/// @remarks Parallel deserialization is disabled by default.  Projects can enable it with the
+	/// @c SceneManager/ParallelDeserialization key in their project file.  It applies to LoadEntitiesFromYAML() and
+	/// LoadEntitiesFromTextFile(), but not to LoadEntitiesFromTextFileAsync(), which is bound by a per-frame budget.
+	EP_API static void SetParallelDeserialization(bool enabled);
+
+	/// Register the storage pool of a component type, making the type available to View.
+	/// @tparam T The component type.
+	/// @param pool The SparseSet holding every component of type @c T.  Must outlive SceneManager.
+	/// @remarks Pool registration is independent of RegisterComponentType(), which is still required for deletion
+	/// and serialization support.
+	/// @remarks The removal logs of registered pools are trimmed to Constants::ChangeHistoryFrames frames.
+	template <typename T>
+	static void RegisterComponentPool(SparseSet<T>& pool)
+	{
+		registerComponentPool(std::type_index(typeid(T)), &pool);
+	}
+	/// Get the registered storage pool of a component type.
+	/// @tparam T The component type.
+	/// @return A pointer to the component pool, or @c nullptr if no pool was registered for @c T.
+	template <typename T>
+	static SparseSet<T>* GetComponentPool()
+	{
+		return static_cast<SparseSet<T>*>(getComponentPool(std::type_index(typeid(T))));
+	}
+
+	template <typename... Ts>
+	class View;
+
 	/// Spawn a new, empty entity.
 	/// @param name The HashName of the entity.
 	/// @param position The starting position of the entity.
 	/// @param rotation The starting orientation of the entity.
 	/// @param scale The starting scale of the entity.
-	/// @return The ID of the created entity.
+	/// @return The ID of the created entity, or @c 0 if every ID in the spawned range is in use.
 	EP_API static EntityID CreateEntity(HashName name,
 		glm::vec3 position = glm::vec3(),
 		glm::quat rotation = glm::quat(),
 		glm::vec3 scale = glm::vec3());
+	/// A list of entities, used as the payload of the @c EntitiesDeleted event.
+	/// @remarks The list is only valid while the event is being handled.
+	struct EntityList
+	{
+		const EntityID* entities;
+		size_t count;
+	};
+
 	/// Remove an entity from the scene.
 	/// @param entity The ID of the entity to delete.
+	/// @remarks The entity's children, and all of their descendants, are deleted as well.  Equivalent to calling
+	/// DeleteEntities() with a single entity.
 	EP_API static void DeleteEntity(EntityID entity);
+	/// Remove many entities from the scene at once.
+	/// @param entities Pointer to an array of the IDs of the entities to delete.
+	/// @param count The number of IDs in @c entities.
+	/// @remarks The entities' descendants are deleted as well.  Each component type's deletion callbacks are invoked
+	/// once for the whole batch if the type registered a batch deleter, and afterwards a single @c EntitiesDeleted
+	/// event is dispatched with an EntityList of every deleted entity.
+	EP_API static void DeleteEntities(const EntityID* entities, size_t count);
+
+	/// Get the calling thread's command buffer.
+	/// @return The EntityCommandBuffer owned by the calling thread.
+	/// @remarks Systems should record structural changes here instead of making them directly while iterating
+	/// component pools, or while running on a worker thread.  Runtime applies every thread's commands at its sync
+	/// points: after each fixed update step, after the frame update, and before drawing.
+	/// @warning Commands recorded on a thread are discarded if the thread exits before they are applied.
+	EP_API static EntityCommandBuffer& GetCommandBuffer();
+	/// Apply and clear the commands recorded in every thread's command buffer.
+	/// @remarks Runtime calls this at each sync point.  It must be called from the main thread while no other thread
+	/// is recording commands.
+	EP_API static void ApplyCommandBuffers();
 	/// Remove all spawned entities from the scene.
-	/// @note This function does not affect entities that were created by loading a scene file.
+	/// @note This function does not affect entities that were created by loading a scene file, unless they are
+	/// descendants of a spawned entity.
 	EP_API static void PurgeSpawnedEntities();
 
+	/// Get the size of the spawned EntityID range.
+	/// @return The highest slot index available to spawned entities.  Scene file entities use IDs above this value.
+	EP_API static size_t GetSpawnedIDRange();
+
 	/// Check whether an entity currently exists in the scene.
 	/// @param entity The EntityID to check.
 	/// @return @c true if entity exists.
+	/// @remarks IDs of deleted entities stay invalid even after their slots are reused by newly spawned entities.
 	EP_API static bool IsEntityValid(EntityID entity);
 
+	/// Attach an entity to a parent entity.
+	/// @param entity The ID of the entity to modify.
+	/// @param parent The ID of the new parent, or @c 0 to detach the entity from its current parent.
+	/// @return @c true if the parent was changed.  Fails if either entity does not exist, or if @c parent is a
+	/// descendant of @c entity.
+	/// @remarks The entity's position, rotation, and scale are relative to its parent, and are kept as-is.  The entity
+	/// will move with its new parent.
+	EP_API static bool SetEntityParent(EntityID entity, EntityID parent);
+	/// Get the parent of an entity.
+	/// @param entity The ID of the entity to query.
+	/// @return The ID of the entity's parent, or @c 0 if it has none.
+	EP_API static EntityID GetEntityParent(EntityID entity);
+	/// Get the children of an entity.
+	/// @param entity The ID of the entity to query.
+	/// @return The IDs of the entity's direct children.
+	EP_API static std::vector<EntityID> GetEntityChildren(EntityID entity);
+
+	/// Get the world transform of an entity.
+	/// @param entity The ID of the entity to query.
+	/// @return The matrix transforming the entity's local space into world space.
+	/// @remarks World transforms are cached, and are only recalculated for entities whose transform, or whose
+	/// ancestors' transforms, have changed.  The cache is brought up to date at the start of each draw.
+	EP_API static glm::mat4 GetEntityWorldMatrix(EntityID entity);
+	/// Get the world transforms of many entities at once.
+	/// @param entities Pointer to an array of the IDs of the entities to query.
+	/// @param count The number of IDs in @c entities.
+	/// @param outMatrices Pointer to an array of @c count matrices to receive the world transforms.
+	EP_API static void GetEntityWorldMatrices(const EntityID* entities, size_t count, glm::mat4* outMatrices);
+
 	/// Get the position of an entity.
 	/// @param entity The ID of the entity to query.
-	/// @return The position of the entity, expressed as a vec3.
+	/// @return The position of the entity relative to its parent, expressed as a vec3.
 	EP_API static glm::vec3 GetEntityPosition(EntityID entity);
 	/// Get the rotation of an entity.
 	/// @param entity The ID of the entity to query.
-	/// @return The entity's orientation, expressed as a quaternion.
+	/// @return The entity's orientation relative to its parent, expressed as a quaternion.
 	EP_API static glm::quat GetEntityRotation(EntityID entity);
 	/// Get the scale values of an entity.
 	/// @param entity The ID of the entity to query.
-	/// @return The entity's scale values, expressed as a vec3.
+	/// @return The entity's scale values relative to its parent, expressed as a vec3.
 	EP_API static glm::vec3 GetEntityScale(EntityID entity);
 
+	/// Set the position of an entity.
+	/// @param entity The ID of the entity to modify.
+	/// @param position The new position of the entity, relative to its parent.
+	EP_API static void SetEntityPosition(EntityID entity, glm::vec3 position);
+	/// Set the rotation of an entity.
+	/// @param entity The ID of the entity to modify.
+	/// @param rotation The new orientation of the entity, relative to its parent.
+	EP_API static void SetEntityRotation(EntityID entity, glm::quat rotation);
+	/// Set the scale values of an entity.
+	/// @param entity The ID of the entity to modify.
+	/// @param scale The new scale values of the entity, relative to its parent.
+	EP_API static void SetEntityScale(EntityID entity, glm::vec3 scale);
+
+	/// Get the transforms of many entities at once.
+	/// @param entities Pointer to an array of the IDs of the entities to query.
+	/// @param count The number of IDs in @c entities.
+	/// @param outPositions Pointer to an array of @c count vec3s to receive entity positions.  May be @c nullptr.
+	/// @param outRotations Pointer to an array of @c count quats to receive entity rotations.  May be @c nullptr.
+	/// @param outScales Pointer to an array of @c count vec3s to receive entity scale values.  May be @c nullptr.
+	/// @remarks Output arrays are filled in the same order as @c entities.
+	EP_API static void GetEntityTransforms(const EntityID* entities, size_t count,
+		glm::vec3* outPositions, glm::quat* outRotations, glm::vec3* outScales);
+	/// Set the transforms of many entities at once.
+	/// @param entities Pointer to an array of the IDs of the entities to modify.
+	/// @param count The number of IDs in @c entities.
+	/// @param positions Pointer to an array of @c count new positions.  If @c nullptr, positions are unchanged.
+	/// @param rotations Pointer to an array of @c count new rotations.  If @c nullptr, rotations are unchanged.
+	/// @param scales Pointer to an array of @c count new scale values.  If @c nullptr, scale values are unchanged.
+	EP_API static void SetEntityTransforms(const EntityID* entities, size_t count,
+		const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales);
+
+	/// A read-only view of the transforms of a contiguous block of entities.
+	/// @remarks Each array contains @c count elements, and element @c i of each array belongs to @c entities[i].
+	struct TransformBlock
+	{
+		const EntityID* entities;
+		const glm::vec3* positions;
+		const glm::quat* rotations;
+		const glm::vec3* scales;
+		size_t count;
+	};
+	/// Get the number of transform blocks in the scene.
+	/// @return The number of blocks needed to cover every entity in the scene.
+	EP_API static size_t GetTransformBlockCount();
+	/// Get a read-only view of a block of entity transforms.
+	/// @param block The block number, in [0, GetTransformBlockCount()).
+	/// @return A TransformBlock over SceneManager's internal transform arrays.
+	/// @remarks Entity storage is allocated in fixed-size blocks that never move, so iterating every block visits every
+	/// entity in the scene while streaming through contiguous memory.
+	/// @warning Block contents are reordered when entities are deleted.
+	EP_API static TransformBlock GetTransformBlock(size_t block);
+
+	/// Get the positions and rotations of a block of entities, interpolated between fixed timesteps.
+	/// @param block The block number, in [0, GetTransformBlockCount()).
+	/// @param outPositions Pointer to an array of @c count vec3s to receive interpolated positions, where @c count is
+	/// the block's TransformBlock::count.  May be @c nullptr.
+	/// @param outRotations Pointer to an array of @c count quats to receive interpolated rotations.  May be
+	/// @c nullptr.
+	/// @remarks SceneManager keeps each entity's local position and rotation from the start of the latest fixed
+	/// timestep.  Results are blended between those and the current values by Time::FixedFrameInterp(), using
+	/// linear interpolation for positions and normalized linear interpolation for rotations.
+	/// @remarks Transform changes made outside of FixedUpdate() are treated as teleports, and are not interpolated.
+	EP_API static void GetInterpolatedTransformBlock(size_t block, glm::vec3* outPositions, glm::quat* outRotations);
+	/// Get the positions and rotations of many entities, interpolated between fixed timesteps.
+	/// @param entities Pointer to an array of the IDs of the entities to query.
+	/// @param count The number of IDs in @c entities.
+	/// @param outPositions Pointer to an array of @c count vec3s to receive interpolated positions.  May be
+	/// @c nullptr.
+	/// @param outRotations Pointer to an array of @c count quats to receive interpolated rotations.  May be
+	/// @c nullptr.
+	/// @remarks See GetInterpolatedTransformBlock().
+	EP_API static void GetInterpolatedEntityTransforms(const EntityID* entities, size_t count,
+		glm::vec3* outPositions, glm::quat* outRotations);
+	/// Get the world transforms of many entities, interpolated between fixed timesteps.
+	/// @param entities Pointer to an array of the IDs of the entities to query.
+	/// @param count The number of IDs in @c entities.
+	/// @param outMatrices Pointer to an array of @c count matrices to receive the world transforms.
+	/// @remarks Each ancestor's position and rotation is interpolated as well.  Scale is not interpolated.  Renderers
+	/// should use these matrices, so that motion stays smooth when the fixed timestep is longer than a frame.
+	/// @remarks The matrices are cached alongside the world transform cache, and are recalculated in one hierarchy
+	/// pass during PreDraw(), or on the first call after a transform changes.  Each call is a lookup per entity.
+	EP_API static void GetEntityInterpolatedWorldMatrices(const EntityID* entities, size_t count,
+		glm::mat4* outMatrices);
+
 	/// Get the IDs of all entities with a specific component type attached.
 	/// @param componentType The HashName of the component type.
 	/// @return A vector of all EntityIDs associated with at least one component of the given type.
 	EP_API static std::vector<EntityID> GetEntitiesWithComponent(HashName componentType);
 
+	/// Mark the present moment for change queries.
+	/// @return A tick to pass to GetEntitiesChangedSince(), GetEntitiesDeletedSince(), and the change queries of
+	/// component pools.  Every change made after this call is reported as changed since the returned tick, and no
+	/// earlier change is.
+	/// @remarks A system typically captures a tick each time it finishes processing changes, and passes it to its
+	/// next round of change queries.
+	EP_API static uint32_t CaptureChangeTick();
+	/// Get the oldest tick for which removals are still tracked.
+	/// @return The tick captured at the start of the oldest frame in the removal history, or @c 0 if no removal has
+	/// been discarded yet.
+	/// @remarks Removal queries for ticks older than this may miss removals, so callers should fall back to
+	/// processing everything.
+	EP_API static uint32_t GetOldestTrackedTick();
+	/// Find the entities whose transforms changed after a tick.
+	/// @param tick A tick captured with CaptureChangeTick().
+	/// @param outEntities Receives the IDs of every entity created, or whose transform or an ancestor's transform was
+	/// set, after @c tick.  Existing contents are discarded.
+	EP_API static void GetEntitiesChangedSince(uint32_t tick, std::vector<EntityID>& outEntities);
+	/// Find the entities deleted after a tick.
+	/// @param tick A tick captured with CaptureChangeTick().
+	/// @param outEntities Receives the IDs of every entity deleted after @c tick, in order of deletion.  Existing
+	/// contents are discarded.
+	/// @remarks Component additions and removals are tracked by each component pool.  See SparseSet.
+	EP_API static void GetEntitiesDeletedSince(uint32_t tick, std::vector<EntityID>& outEntities);
+
+	/// Find the entities within a distance of a point.
+	/// @param center The center of the search sphere, in world space.
+	/// @param radius The radius of the search sphere.
+	/// @param outEntities Receives the IDs of every entity whose world position lies inside the sphere, in no
+	/// particular order.  Existing contents are discarded.
+	/// @remarks Entity positions are kept in a spatial hash grid which is updated along with world transforms, so
+	/// queries only visit entities in nearby cells.
+	EP_API static void QueryEntitiesInRadius(glm::vec3 center, float radius, std::vector<EntityID>& outEntities);
+	/// Find the entities inside an axis-aligned box.
+	/// @param min The corner of the box with the lowest coordinates, in world space.
+	/// @param max The corner of the box with the highest coordinates, in world space.
+	/// @param outEntities Receives the IDs of every entity whose world position lies inside the box, in no particular
+	/// order.  Existing contents are discarded.
+	EP_API static void QueryEntitiesInBox(glm::vec3 min, glm::vec3 max, std::vector<EntityID>& outEntities);
+	/// Find the entities closest to a point.
+	/// @param point The point to search from, in world space.
+	/// @param count The maximum number of entities to find.
+	/// @param outEntities Receives the IDs of the @c count entities nearest to @c point, ordered from nearest to
+	/// farthest.  Existing contents are discarded.
+	EP_API static void QueryNearestEntities(glm::vec3 point, size_t count, std::vector<EntityID>& outEntities);
+
 	/// Serialize entities to a text file.
 	/// @param path The virtual path to the destination file.
 	/// @param entities The IDs of the entities to serialize.  If empty, all entities will be serialized.
@@ -104,24 +405,187 @@ public:
 	/// All other entities are simply added to the scene, which can cause entity duplication.
 	EP_API static bool LoadEntitiesFromTextFile(const std::string& path);
 
+	/// Populate the scene with entities serialized in a text file, spreading the work across multiple frames.
+	/// @param path The virtual path to the file to load.
+	/// @remarks The file is read and parsed on a worker thread.  Entities and components are then added to the scene
+	/// at the start of each Update(), within the time budget set by SetSceneLoadBudget().  When loading finishes, a
+	/// @c SceneLoaded event is dispatched, or @c SceneLoadFailed if the file could not be parsed.  Both carry the
+	/// file's virtual path as a @c std::string payload.
+	/// @remarks Multiple loads may be queued.  They are applied in the order they were requested.
+	EP_API static void LoadEntitiesFromTextFileAsync(const std::string& path);
+	/// Set the time budget for incremental scene loading.
+	/// @param microseconds The maximum time spent adding loaded entities to the scene each frame.
+	/// @note At least one entity or component is added per frame, regardless of the budget.
+	EP_API static void SetSceneLoadBudget(unsigned int microseconds);
+	/// Check whether any incremental scene loads are in progress.
+	/// @return @c true if a scene requested with LoadEntitiesFromTextFileAsync() has not finished loading.
+	EP_API static bool IsSceneLoading();
+	/// Get the progress of the current incremental scene load.
+	/// @return The fraction of the current load's entities and components added to the scene, in [0.0, 1.0].
+	/// Returns @c 0.0 while the file is being parsed, and @c 1.0 if no load is in progress.
+	EP_API static float GetSceneLoadProgress();
+
+	/// Serialize entities to a binary scene file (.epscene).
+	/// @param path The virtual path to the destination file.
+	/// @param entities The IDs of the entities to serialize.  If empty, all entities will be serialized.
+	/// @return @c true if the file was saved successfully.
+	EP_API static bool SaveEntitiesToBinaryFile(const std::string& path, const std::vector<EntityID>& entities = {});
+	/// Populate the scene with entities serialized in binary scene format.
+	/// @param data Pointer to the binary scene data.  Must be 8-byte aligned.
+	/// @param size The size of the binary scene data in bytes.
+	/// @return @c true if deserialization was successful.
+	/// @remarks Entities are replaced or added following the same rules as LoadEntitiesFromYAML().
+	EP_API static bool LoadEntitiesFromBinary(const uint8_t* data, size_t size);
+	/// Populate the scene with entities serialized in a binary scene file (.epscene).
+	/// @param path The virtual path to the file to load.
+	/// @return @c true if deserialization was successful.
+	/// @remarks The file is memory-mapped and read in place.
+	EP_API static bool LoadEntitiesFromBinaryFile(const std::string& path);
+
+	/// Convert a text scene file to a binary scene file.
+	/// @param srcPath The virtual path to the text scene file.
+	/// @param dstPath The virtual path to the binary scene file to create.
+	/// @return @c true if conversion was successful.
+	/// @pre The scene must not contain any entities.
+	/// @remarks Conversion loads the scene through the registered component systems, then saves and removes it.
+	/// Spawned-range EntityIDs are renumbered, as they are whenever a scene is loaded.
+	EP_API static bool ConvertTextSceneToBinary(const std::string& srcPath, const std::string& dstPath);
+	/// Convert a binary scene file to a text scene file.
+	/// @param srcPath The virtual path to the binary scene file.
+	/// @param dstPath The virtual path to the text scene file to create.
+	/// @return @c true if conversion was successful.
+	/// @pre The scene must not contain any entities.
+	/// @remarks Conversion loads the scene through the registered component systems, then saves and removes it.
+	/// Spawned-range EntityIDs are renumbered, as they are whenever a scene is loaded.
+	EP_API static bool ConvertBinarySceneToText(const std::string& srcPath, const std::string& dstPath);
+
+	/// A copy of the entire scene, which can be restored at any time.
+	/// @remarks Snapshots keep their storage when retaken, so taking a snapshot every frame does not allocate once the
+	/// scene stops growing.
+	class Snapshot
+	{
+	public:
+		EP_API Snapshot();
+		EP_API ~Snapshot();
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+
+		/// Check whether the snapshot holds a scene.
+		/// @return @c true if TakeSnapshot() has succeeded with this snapshot.
+		EP_API bool IsValid() const;
+		/// Get the memory used by the snapshot.
+		/// @return The size of the snapshot's binary data in bytes.
+		EP_API size_t Size() const;
+
+	private:
+		friend class SceneManager;
+		struct Data;
+		std::unique_ptr<Data> m_data;
+
+		void releaseData();
+	};
+
+	/// Copy the entire scene into a snapshot.
+	/// @param snapshot The snapshot to overwrite.
+	/// @return @c true if the snapshot was taken.  Fails while a scene is loading asynchronously.
+	/// @remarks Entity storage is copied with memcpy.  Component types are copied by their SaveSnapshotFn callbacks,
+	/// or by their text serialization callbacks if they have none.
+	EP_API static bool TakeSnapshot(Snapshot& snapshot);
+	/// Replace the entire scene with the contents of a snapshot.
+	/// @param snapshot The snapshot to restore.
+	/// @return @c true if the snapshot was restored.  Fails while a scene is loading asynchronously.
+	/// @remarks No @c EntitiesDeleted events are dispatched for entities removed by the restore.  A @c SceneRestored
+	/// event is dispatched instead.  Unapplied entity commands are kept.
+	/// @remarks The snapshot is left intact, so it can be restored again.
+	/// @remarks Spawned entity generations are not rolled back, so IDs handed out after the snapshot was taken stay
+	/// invalid, and are never reused by entities spawned after the restore.
+	EP_API static bool RestoreSnapshot(const Snapshot& snapshot);
+
 	// System stuff
 
 	/// A pointer to an Update(), FixedUpdate(), PreDraw(), or SceneDraw() function.
 	typedef void(*CoreCallFn)();
 	/// Register a FixedUpdate() callback.
 	/// @param func Pointer to the @c FixedUpdate() callback.
-	EP_API static void RegisterFixedUpdateFn(CoreCallFn func);
+	/// @param name The name of the callback in timing statistics.  A name is generated if empty.
+	/// @remarks Equivalent to a main-thread system which conflicts with every other system in its phase.
+	EP_API static void RegisterFixedUpdateFn(CoreCallFn func, const std::string& name = std::string());
 	/// Register an Update() callback.
 	/// @param func Pointer to the @c Update() callback.
-	EP_API static void RegisterUpdateFn(CoreCallFn func);
+	/// @param name The name of the callback in timing statistics.  A name is generated if empty.
+	/// @remarks Equivalent to a main-thread system which conflicts with every other system in its phase.
+	EP_API static void RegisterUpdateFn(CoreCallFn func, const std::string& name = std::string());
 	/// Register a PreDraw() callback.
 	/// @param func Pointer to the @c PreDraw() callback.
-	EP_API static void RegisterPreDrawFn(CoreCallFn func);
+	/// @param name The name of the callback in timing statistics.  A name is generated if empty.
+	/// @remarks Equivalent to a main-thread system which conflicts with every other system in its phase.
+	EP_API static void RegisterPreDrawFn(CoreCallFn func, const std::string& name = std::string());
+
+	/// The frame phases in which systems can run.
+	enum class SystemPhase
+	{
+		FixedUpdate,
+		Update,
+		PreDraw
+	};
+	/// Register a system with the component types it accesses.
+	/// @param phase The phase to run the system in.
+	/// @param func Pointer to the system function.
+	/// @param reads The HashNames of the component types the system reads.  @c HN("Transform") stands for entity
+	/// transforms and hierarchy.
+	/// @param writes The HashNames of the component types the system modifies.  A type does not need to be listed
+	/// in both.
+	/// @param mainThreadOnly Whether the system must run on the main thread.
+	/// @param name The name of the system in timing statistics.  A name is generated if empty.
+	/// @remarks Each phase, systems which access no common type, or only read it, may run concurrently on a
+	/// worker pool.  A system always runs after every conflicting system registered before it, so results do not
+	/// depend on thread timing.
+	/// @warning Systems that may run off the main thread must record structural changes with GetCommandBuffer(), and
+	/// must not dispatch events or call Graphics functions.  They may post events with Events::Channel::Post() and
+	/// call HN().  Set @c mainThreadOnly for systems that need to.
+	EP_API static void RegisterSystem(SystemPhase phase, CoreCallFn func,
+		const std::vector<HashName>& reads, const std::vector<HashName>& writes, bool mainThreadOnly = false,
+		const std::string& name = std::string());
+	/// Enable or disable concurrent execution of systems.
+	/// @param enabled Whether non-conflicting systems run concurrently.
+	/// @remarks Parallel systems are enabled by default.  When disabled, every system runs on the main thread in
+	/// registration order, which is useful for debugging.  Projects can configure this with the
+	/// @c SceneManager/ParallelSystems and @c SceneManager/SystemWorkerThreads keys in their project file.
+	EP_API static void SetParallelSystems(bool enabled);
 	/// Register a SceneDraw() callback.
 	/// @param func Pointer to the @c SceneDraw() callback.
+	/// @param name The name of the callback in timing statistics.  A name is generated if empty.
 	/// @remarks @c SceneDraw() callbacks are invoked every time SceneManager::DrawScene() is invoked.
 	/// This may occur multiple times per frame.
-	EP_API static void RegisterSceneDrawFn(CoreCallFn func);
+	EP_API static void RegisterSceneDrawFn(CoreCallFn func, const std::string& name = std::string());
+
+	/// CPU time statistics for one registered system or callback.
+	struct SystemTimingStats
+	{
+		std::string name;
+		std::string phase; // "FixedUpdate", "Update", "PreDraw", or "SceneDraw"
+		uint64_t invocations; // Timed invocations since registration or the last reset
+		size_t sampleCount; // Invocations in the rolling window
+		double minMs, avgMs, maxMs, p99Ms; // Over the rolling window
+	};
+	/// Get CPU time statistics for every registered system and callback.
+	/// @return One entry per registration, in registration order.
+	/// @remarks Statistics cover the last Constants::SystemTimingWindow invocations of each system.
+	EP_API static std::vector<SystemTimingStats> GetSystemTimingStats();
+	/// Discard all recorded system timings.
+	EP_API static void ResetSystemTimingStats();
+	/// Write system timing statistics to a file.
+	/// @param path The virtual path of the file.  JSON is written if the path ends in ".json", and CSV otherwise.
+	/// @return @c true if the file was written.
+	/// @remarks Projects can dump statistics periodically by setting the @c SceneManager/SystemTimingDumpPath key
+	/// in their project file.
+	EP_API static bool DumpSystemTimingStats(const std::string& path);
+	/// Enable or disable system timing.
+	/// @param enabled Whether system invocations are timed.
+	/// @remarks Timing is enabled by default in Debug and Dev builds, and disabled in Release builds.  Projects can
+	/// override this with the @c SceneManager/SystemTiming key in their project file.  Timing costs two clock reads
+	/// per invocation.
+	EP_API static void SetSystemTimingEnabled(bool enabled);
 
 	/// Render the scene with the current camera and render settings.
 	EP_API static void DrawScene();
@@ -129,10 +593,88 @@ public:
 private:
 	friend class Runtime;
 
+	EP_API static void registerComponentPool(std::type_index type, SparseSetBase* pool);
+	EP_API static SparseSetBase* getComponentPool(std::type_index type);
+
 	static void Init();
+	static void Cleanup();
 	static void FixedUpdate();
 	static void Update();
 	static void PreDraw();
 };
 
+/// A query over every entity with all of a set of component types attached.
+/// @tparam Ts The component types to match.  Each must have a pool registered with
+/// SceneManager::RegisterComponentPool().
+/// @remarks Views reference the component pools directly, so constructing and iterating a View does not allocate.
+/// Iteration walks the smallest pool and skips entities that are missing from any of the others.
+/// @remarks Every entity has a transform, so transforms are not a View parameter.  Use the bulk transform accessors
+/// in SceneManager to fetch them.
+template <typename... Ts>
+class SceneManager::View
+{
+	static_assert(sizeof...(Ts) > 0, "SceneManager::View: At least one component type is required.");
+
+public:
+	/// Create a View over the current contents of the component pools.
+	View() : m_pools(GetComponentPool<Ts>()...)
+	{
+		const SparseSetBase* pools[] = { std::get<SparseSet<Ts>*>(m_pools)... };
+		for (const SparseSetBase* pool : pools)
+		{
+			if (!pool)
+			{
+				EP_ERROR("SceneManager::View: A viewed component type has no registered pool!  "
+					"Did you call SceneManager::RegisterComponentPool()?");
+				m_smallest = nullptr;
+				return;
+			}
+			if (!m_smallest || pool->Size() < m_smallest->Size())
+			{
+				m_smallest = pool;
+			}
+		}
+	}
+
+	/// Invoke a function for every matching entity.
+	/// @param fn The function to invoke.  Called as @c fn(EntityID, Ts&...) with references to each component.
+	/// @remarks Entities are visited in reverse pool order, so @c fn may safely delete the components of the
+	/// entity it is visiting.  Adding or removing components of other entities invalidates the iteration, so record
+	/// such changes in SceneManager::GetCommandBuffer() instead.
+	template <typename Fn>
+	void Each(Fn&& fn) const
+	{
+		if (!m_smallest)
+			return;
+
+		for (size_t i = m_smallest->Size(); i > 0; i--)
+		{
+			EntityID entity = m_smallest->EntityAt(i - 1);
+			if ((std::get<SparseSet<Ts>*>(m_pools)->Contains(entity) && ...))
+			{
+				fn(entity, std::get<SparseSet<Ts>*>(m_pools)->Get(entity)...);
+			}
+		}
+	}
+
+	/// Check whether an entity matches the View.
+	/// @param entity The EntityID to check.
+	/// @return @c true if @c entity has every component type in the View.
+	bool Contains(EntityID entity) const
+	{
+		return m_smallest && (std::get<SparseSet<Ts>*>(m_pools)->Contains(entity) && ...);
+	}
+
+	/// Get an upper bound on the number of matching entities.
+	/// @return The size of the smallest component pool in the View.
+	size_t SizeHint() const
+	{
+		return m_smallest ? m_smallest->Size() : 0;
+	}
+
+private:
+	std::tuple<SparseSet<Ts>*...> m_pools;
+	const SparseSetBase* m_smallest = nullptr;
+};
+
 }
@@ -0,0 +1,156 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <type_traits>
+#include "Enterprise/Core.h"
+
+namespace Enterprise
+{
+
+/// A growable array which allocates storage in fixed-size chunks.
+/// @tparam T The element type.  Must be default-constructible.
+/// @tparam ChunkSize The number of elements per chunk.  Must be a power of two.
+/// @remarks Growing a ChunkedArray never moves existing elements, so pointers and references to elements remain
+/// valid until the element itself is removed.  Elements are contiguous within each chunk, so bulk processing should
+/// iterate chunk by chunk using ChunkCount(), ChunkData(), and ChunkLength().
+template <typename T, size_t ChunkSize = 4096>
+class ChunkedArray
+{
+	static_assert((ChunkSize & (ChunkSize - 1)) == 0, "ChunkedArray: ChunkSize must be a power of two.");
+
+public:
+	/// The number of elements stored per chunk.
+	static constexpr size_t ElementsPerChunk = ChunkSize;
+
+	/// Access an element.
+	/// @param index The position of the element.
+	/// @return A reference to the element.
+	inline T& operator[](size_t index)
+	{
+		EP_ASSERT_SLOW(index < m_size);
+		return m_chunks[index / ChunkSize][index % ChunkSize];
+	}
+	/// Access an element.
+	/// @param index The position of the element.
+	/// @return A reference to the element.
+	inline const T& operator[](size_t index) const
+	{
+		EP_ASSERT_SLOW(index < m_size);
+		return m_chunks[index / ChunkSize][index % ChunkSize];
+	}
+
+	/// Access the last element.
+	/// @return A reference to the last element.
+	inline T& Back() { return (*this)[m_size - 1]; }
+
+	/// Append an element, allocating a new chunk if the current ones are full.
+	/// @param value The value to append.
+	/// @return A reference to the appended element.
+	T& PushBack(const T& value)
+	{
+		if (m_size == m_chunks.size() * ChunkSize)
+		{
+			m_chunks.emplace_back(std::make_unique<T[]>(ChunkSize));
+		}
+
+		T& element = m_chunks[m_size / ChunkSize][m_size % ChunkSize];
+		element = value;
+		m_size++;
+		return element;
+	}
+
+	/// Remove the last element.  Chunk storage is retained for reuse.
+	void PopBack()
+	{
+		EP_ASSERT_SLOW(m_size > 0);
+		m_size--;
+		m_chunks[m_size / ChunkSize][m_size % ChunkSize] = T();
+	}
+
+	/// Remove all elements.  Chunk storage is retained for reuse.
+	void Clear()
+	{
+		while (m_size > 0)
+		{
+			PopBack();
+		}
+	}
+
+	/// Allocate enough chunks to hold a number of elements without further allocation.
+	/// @param capacity The number of elements to reserve space for.
+	void Reserve(size_t capacity)
+	{
+		while (m_chunks.size() * ChunkSize < capacity)
+		{
+			m_chunks.emplace_back(std::make_unique<T[]>(ChunkSize));
+		}
+	}
+
+	/// Append the raw bytes of every element to a buffer.
+	/// @param outData The buffer to append to.
+	/// @remarks Only available for trivially copyable element types.  Each chunk is copied with a single memcpy.
+	void AppendBytes(std::vector<uint8_t>& outData) const
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "ChunkedArray: AppendBytes() requires a trivially copyable T.");
+
+		size_t start = outData.size();
+		outData.resize(start + m_size * sizeof(T));
+		for (size_t chunk = 0; chunk < ChunkCount(); chunk++)
+		{
+			std::memcpy(outData.data() + start + chunk * ChunkSize * sizeof(T),
+				m_chunks[chunk].get(), ChunkLength(chunk) * sizeof(T));
+		}
+	}
+	/// Replace the contents of the array with elements copied from raw bytes.
+	/// @param data Pointer to the bytes of @c count elements, as written by AppendBytes().
+	/// @param count The number of elements to copy.
+	/// @remarks Only available for trivially copyable element types.  Existing chunks are reused.
+	void AssignBytes(const uint8_t* data, size_t count)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "ChunkedArray: AssignBytes() requires a trivially copyable T.");
+
+		while (m_size > count)
+		{
+			PopBack();
+		}
+		Reserve(count);
+		m_size = count;
+		for (size_t chunk = 0; chunk < ChunkCount(); chunk++)
+		{
+			std::memcpy(m_chunks[chunk].get(), data + chunk * ChunkSize * sizeof(T), ChunkLength(chunk) * sizeof(T));
+		}
+	}
+
+	/// Get the number of elements in the array.
+	/// @return The number of elements.
+	inline size_t Size() const { return m_size; }
+	/// Get the number of elements the array can hold without allocating.
+	/// @return The allocated capacity, in elements.
+	inline size_t Capacity() const { return m_chunks.size() * ChunkSize; }
+
+	/// Get the number of chunks containing elements.
+	/// @return The number of non-empty chunks.
+	inline size_t ChunkCount() const { return (m_size + ChunkSize - 1) / ChunkSize; }
+	/// Get a pointer to the elements in a chunk.
+	/// @param chunk The chunk number.
+	/// @return A pointer to the first element of the chunk.
+	inline T* ChunkData(size_t chunk) { return m_chunks[chunk].get(); }
+	/// Get a pointer to the elements in a chunk.
+	/// @param chunk The chunk number.
+	/// @return A pointer to the first element of the chunk.
+	inline const T* ChunkData(size_t chunk) const { return m_chunks[chunk].get(); }
+	/// Get the number of elements in a chunk.
+	/// @param chunk The chunk number.
+	/// @return The number of elements in use in the chunk.
+	inline size_t ChunkLength(size_t chunk) const
+	{
+		return (chunk + 1) * ChunkSize <= m_size ? ChunkSize : m_size - chunk * ChunkSize;
+	}
+
+private:
+	std::vector<std::unique_ptr<T[]>> m_chunks;
+	size_t m_size = 0;
+};
+
+}
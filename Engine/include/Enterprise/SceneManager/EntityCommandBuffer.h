@@ -0,0 +1,124 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+#include <yaml-cpp/yaml.h>
+#include "Enterprise/Core.h"
+#include "Enterprise/SceneManager/SparseSet.h"
+
+namespace Enterprise
+{
+
+/// A recording of structural scene changes, to be applied later at a sync point.
+/// @remarks Creating or deleting entities and components while a system is iterating a component pool invalidates
+/// the iteration.  Systems record those changes in a command buffer instead, and SceneManager applies every recorded
+/// command at the next sync point.  Each thread has its own buffer, obtained with SceneManager::GetCommandBuffer(),
+/// so recording never needs a lock.
+/// @remarks When applied, commands take effect in phases: first all entity creations, then all component additions
+/// and removals in the order they were recorded, then all entity deletions as a single batch.
+class EntityCommandBuffer
+{
+public:
+	/// The generation of pending EntityIDs.  Never assigned to a real entity.
+	static constexpr uint32_t PendingGeneration = UINT32_MAX;
+
+	/// Record the creation of a new spawned entity.
+	/// @param name The HashName of the entity.
+	/// @param position The starting position of the entity.
+	/// @param rotation The starting orientation of the entity.
+	/// @param scale The starting scale of the entity.
+	/// @return A pending EntityID, which can be passed to the other commands in this buffer.  It is replaced by the
+	/// entity's real ID when the buffer is applied.
+	/// @warning Pending EntityIDs are only meaningful to the buffer that returned them.
+	EntityID CreateEntity(HashName name,
+		glm::vec3 position = glm::vec3(),
+		glm::quat rotation = glm::quat(),
+		glm::vec3 scale = glm::vec3())
+	{
+		m_creates.push_back({ name, position, rotation, scale });
+		return EntityID_Make(uint32_t(m_creates.size()), PendingGeneration);
+	}
+
+	/// Record the deletion of an entity.
+	/// @param entity The ID of the entity to delete.  May be a pending EntityID from this buffer.
+	/// @remarks The entity's descendants are deleted as well.
+	void DeleteEntity(EntityID entity)
+	{
+		m_commands.push_back({ CommandType::Delete, entity, HN_NULL, 0, 0 });
+	}
+
+	/// Record the addition of a component, described in the same format as the component type's text scene data.
+	/// @param entity The ID of the entity to attach the component to.  May be a pending EntityID from this buffer.
+	/// @param componentType The HashName of the component type.
+	/// @param data The component data, passed to the type's TextDeserializeFn when the buffer is applied.
+	void AddComponent(EntityID entity, HashName componentType, const YAML::Node& data)
+	{
+		m_commands.push_back({ CommandType::AddComponentYAML, entity, componentType, m_yamlData.size(), 0 });
+		m_yamlData.push_back(data);
+	}
+	/// Record the addition of a component, described in the same format as the component type's binary scene data.
+	/// @param entity The ID of the entity to attach the component to.  May be a pending EntityID from this buffer.
+	/// @param componentType The HashName of the component type.
+	/// @param data Pointer to the component data, which is copied into the buffer.  Passed to the type's
+	/// BinaryDeserializeFn when the buffer is applied.
+	/// @param size The size of the component data in bytes.
+	void AddComponent(EntityID entity, HashName componentType, const uint8_t* data, size_t size)
+	{
+		m_commands.push_back({ CommandType::AddComponentBinary, entity, componentType, m_binaryData.size(), size });
+		m_binaryData.insert(m_binaryData.end(), data, data + size);
+	}
+
+	/// Record the removal of a component.
+	/// @param entity The ID of the entity to remove the component from.  May be a pending EntityID from this buffer.
+	/// @param componentType The HashName of the component type.
+	void RemoveComponent(EntityID entity, HashName componentType)
+	{
+		m_commands.push_back({ CommandType::RemoveComponent, entity, componentType, 0, 0 });
+	}
+
+	/// Check whether any commands have been recorded.
+	/// @return @c true if the buffer holds no commands.
+	bool Empty() const { return m_creates.empty() && m_commands.empty(); }
+
+	/// Discard all recorded commands.
+	void Clear()
+	{
+		m_creates.clear();
+		m_commands.clear();
+		m_yamlData.clear();
+		m_binaryData.clear();
+	}
+
+private:
+	friend class SceneManager;
+
+	enum class CommandType : uint8_t
+	{
+		Delete,
+		AddComponentYAML,
+		AddComponentBinary,
+		RemoveComponent
+	};
+	struct Command
+	{
+		CommandType type;
+		EntityID entity;
+		HashName componentType;
+		size_t payload; // Index into m_yamlData, or offset into m_binaryData
+		size_t size;
+	};
+	struct CreateCommand
+	{
+		HashName name;
+		glm::vec3 position;
+		glm::quat rotation;
+		glm::vec3 scale;
+	};
+
+	std::vector<CreateCommand> m_creates;
+	std::vector<Command> m_commands;
+	std::vector<YAML::Node> m_yamlData;
+	std::vector<uint8_t> m_binaryData;
+};
+
+}
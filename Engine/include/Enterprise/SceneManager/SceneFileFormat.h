@@ -0,0 +1,93 @@
+#pragma once
+#include "Enterprise/Core.h"
+#include "Enterprise/SceneManager/SparseSet.h"
+
+namespace Enterprise
+{
+
+/// Layout of binary scene files (.epscene).
+/// @remarks A binary scene file begins with a Header, followed by sections located by the offsets it contains.  All
+/// offsets are in bytes from the start of the file, and every section starts on an 8-byte boundary.  Values are
+/// stored in native (little-endian) byte order.
+/// @remarks The entity table is stored as parallel arrays, each @c Header::entityCount elements long:
+/// - @c EntityID ids[]
+/// - @c HashName names[]
+/// - @c StringRef nameStrings[]
+/// - @c float positions[][3] (x, y, z)
+/// - @c float rotations[][4] (w, x, y, z)
+/// - @c float scales[][3] (x, y, z)
+/// - @c EntityID parents[] (0 for entities without a parent)
+/// @remarks Each component type is described by a ComponentTypeRecord, which locates an array of ComponentEntry
+/// structures and a blob holding the serialized data of each component.
+namespace SceneFile
+{
+
+/// The magic number at the start of every binary scene file ("EPSC").
+constexpr char Magic[4] = { 'E', 'P', 'S', 'C' };
+/// The binary scene format version written by this build.  Files of other versions are rejected.
+constexpr uint32_t Version = 2;
+/// Written to every header to detect files saved with a different byte order.
+constexpr uint32_t ByteOrderMark = 0x01020304;
+
+/// A reference to a string in the string table.
+struct StringRef
+{
+	uint32_t offset; // From the start of the string table
+	uint32_t length;
+};
+
+/// The binary scene file header.
+struct Header
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t byteOrderMark;
+	uint32_t reserved;
+
+	uint64_t entityCount;
+	uint64_t idsOffset;
+	uint64_t namesOffset;
+	uint64_t nameStringsOffset;
+	uint64_t positionsOffset;
+	uint64_t rotationsOffset;
+	uint64_t scalesOffset;
+	uint64_t parentsOffset;
+
+	uint64_t componentTypeCount;
+	uint64_t componentTypesOffset;
+
+	uint64_t stringTableOffset;
+	uint64_t stringTableSize;
+};
+
+/// How the components of a type are encoded.
+enum class ComponentEncoding : uint32_t
+{
+	Binary, // Written by a BinarySerializeFn
+	YAML	// Written by a TextSerializeFn, for component types without binary callbacks
+};
+
+/// Describes the serialized components of one type.
+struct ComponentTypeRecord
+{
+	HashName type;
+	StringRef typeName;
+	ComponentEncoding encoding;
+	uint32_t reserved;
+	uint64_t componentCount;
+	uint64_t entriesOffset; // Array of componentCount ComponentEntry structures
+	uint64_t dataOffset;
+	uint64_t dataSize;
+};
+
+/// Locates the serialized data of one component.
+struct ComponentEntry
+{
+	EntityID entity;
+	uint64_t offset; // From ComponentTypeRecord::dataOffset
+	uint64_t size;
+};
+
+}
+
+}
@@ -0,0 +1,421 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "Enterprise/Core.h"
+#include "Enterprise/SceneManager/ChunkedArray.h"
+
+/// A unique identifier for a scene entity.
+/// @remarks The low 32 bits hold the entity's slot index, and the high 32 bits hold a generation counter.  Spawned
+/// entity slots are recycled, and each recycle increments the slot's generation, so stale IDs never alias new entities.
+typedef uint64_t EntityID;
+
+/// Get the slot index portion of an EntityID.
+/// @param entity The EntityID.
+/// @return The entity's slot index.
+constexpr uint32_t EntityID_Index(EntityID entity) { return uint32_t(entity & 0xFFFFFFFFull); }
+/// Get the generation portion of an EntityID.
+/// @param entity The EntityID.
+/// @return The entity's generation.
+constexpr uint32_t EntityID_Generation(EntityID entity) { return uint32_t(entity >> 32); }
+/// Assemble an EntityID from a slot index and generation.
+/// @param index The slot index.
+/// @param generation The generation of the slot.
+/// @return The assembled EntityID.
+constexpr EntityID EntityID_Make(uint32_t index, uint32_t generation) { return (EntityID(generation) << 32) | index; }
+
+namespace Enterprise
+{
+
+/// Get the tick that scene changes made now are stamped with.
+/// @return The current change tick.
+/// @remarks See SceneManager::CaptureChangeTick().
+EP_API uint32_t CurrentChangeTick();
+
+/// The type-independent part of a SparseSet: a packed set of EntityIDs.
+/// @remarks A paged sparse array maps each entity's slot index to its position in a dense array of EntityIDs.
+/// Lookup, insertion, and removal are constant time, and iterating over the dense array touches only live entries.
+/// Removal swaps the last entry into the vacated slot, so dense positions are not stable.  The dense array is a
+/// ChunkedArray, so growth never moves existing entries.
+/// @remarks The full EntityID is kept in the dense array, so a lookup with a stale ID (one whose slot has since been
+/// recycled with a new generation) is rejected by a single comparison.
+/// @remarks Each entry carries the change tick of its last modification, and removals are logged with their tick, so
+/// systems can process only the entries that changed since a tick captured with SceneManager::CaptureChangeTick().
+/// Insertion stamps an entry automatically.  Modifying a value in place does not, so call MarkChanged() afterwards.
+class SparseSetBase
+{
+public:
+	/// Check whether an entity has an entry in the set.
+	/// @param entity The EntityID to check.
+	/// @return @c true if @c entity has an entry.
+	inline bool Contains(EntityID entity) const
+	{
+		size_t page = EntityID_Index(entity) / PageSize;
+		if (page >= m_sparse.size() || !m_sparse[page])
+			return false;
+
+		size_t entry = m_sparse[page][EntityID_Index(entity) % PageSize];
+		return entry != 0 && m_dense[entry - 1] == entity;
+	}
+
+	/// Get the dense array position of an entity's entry.
+	/// @param entity The EntityID to look up.
+	/// @return The position of the entity's entry in the dense arrays.
+	/// @pre @c entity must have an entry in the set.
+	inline size_t IndexOf(EntityID entity) const
+	{
+		EP_ASSERT_SLOW(Contains(entity));
+		return m_sparse[EntityID_Index(entity) / PageSize][EntityID_Index(entity) % PageSize] - 1;
+	}
+
+	/// Get the number of entries in the set.
+	/// @return The number of entries.
+	inline size_t Size() const { return m_dense.Size(); }
+
+	/// Get the EntityID at a dense array position.
+	/// @param index The dense position, in [0, Size()).
+	/// @return The EntityID stored at @c index.
+	inline EntityID EntityAt(size_t index) const { return m_dense[index]; }
+
+	/// Get the dense array of EntityIDs.
+	/// @return The dense EntityID array.
+	inline const ChunkedArray<EntityID>& Entities() const { return m_dense; }
+
+	/// Record that an entity's entry was modified.
+	/// @param entity The EntityID of the modified entry.
+	/// @pre @c entity must have an entry in the set.
+	inline void MarkChanged(EntityID entity) { m_changeTicks[IndexOf(entity)] = CurrentChangeTick(); }
+	/// Record that the entry at a dense array position was modified.
+	/// @param index The dense position, in [0, Size()).
+	inline void MarkChangedAt(size_t index) { m_changeTicks[index] = CurrentChangeTick(); }
+	/// Get the tick at which the entry at a dense array position was last inserted or modified.
+	/// @param index The dense position, in [0, Size()).
+	/// @return The entry's change tick.
+	inline uint32_t ChangeTickAt(size_t index) const { return m_changeTicks[index]; }
+
+	/// Get the entities whose entries were inserted or modified after a tick.
+	/// @param tick A tick captured with SceneManager::CaptureChangeTick().
+	/// @param outEntities Receives the IDs, in dense array order.  Existing contents are discarded.
+	void GetChangedSince(uint32_t tick, std::vector<EntityID>& outEntities) const
+	{
+		outEntities.clear();
+		for (size_t chunk = 0; chunk < m_changeTicks.ChunkCount(); chunk++)
+		{
+			const uint32_t* ticks = m_changeTicks.ChunkData(chunk);
+			size_t base = chunk * ChunkedArray<uint32_t>::ElementsPerChunk;
+			for (size_t i = 0; i < m_changeTicks.ChunkLength(chunk); i++)
+			{
+				if (ticks[i] > tick)
+				{
+					outEntities.push_back(m_dense[base + i]);
+				}
+			}
+		}
+	}
+	/// Get the entities whose entries were removed after a tick.
+	/// @param tick A tick captured with SceneManager::CaptureChangeTick().
+	/// @param outEntities Receives the IDs, in order of removal.  Existing contents are discarded.
+	/// @remarks Entities removed and then added again are reported here as well as by GetChangedSince().
+	/// @remarks The removal log only reaches back to SceneManager::GetOldestTrackedTick().
+	void GetRemovedSince(uint32_t tick, std::vector<EntityID>& outEntities) const
+	{
+		outEntities.clear();
+		auto it = std::upper_bound(m_removals.begin(), m_removals.end(), tick,
+			[](uint32_t t, const Removal& removal) { return t < removal.tick; });
+		for (; it != m_removals.end(); it++)
+		{
+			outEntities.push_back(it->entity);
+		}
+	}
+	/// Discard logged removals that are no newer than a tick.
+	/// @param tick The newest tick to discard.
+	/// @remarks SceneManager trims the logs of registered component pools automatically.
+	void TrimRemovals(uint32_t tick)
+	{
+		auto it = std::upper_bound(m_removals.begin(), m_removals.end(), tick,
+			[](uint32_t t, const Removal& removal) { return t < removal.tick; });
+		m_removals.erase(m_removals.begin(), it);
+	}
+
+protected:
+	size_t insertEntity(EntityID entity)
+		// Adds an entity to the end of the dense array and returns its position.
+	{
+		size_t page = EntityID_Index(entity) / PageSize;
+		EP_ASSERTF(page >= m_sparse.size() || !m_sparse[page] || m_sparse[page][EntityID_Index(entity) % PageSize] == 0,
+			"SparseSet: Entity slot already has an entry!");
+
+		if (page >= m_sparse.size())
+		{
+			m_sparse.resize(page + 1);
+		}
+		if (!m_sparse[page])
+		{
+			m_sparse[page] = std::make_unique<size_t[]>(PageSize); // value-initialized to 0
+		}
+
+		m_dense.PushBack(entity);
+		m_changeTicks.PushBack(CurrentChangeTick());
+		m_sparse[page][EntityID_Index(entity) % PageSize] = m_dense.Size();
+		return m_dense.Size() - 1;
+	}
+
+	size_t eraseEntity(EntityID entity)
+		// Swap-removes an entity from the dense array and returns the vacated position.
+	{
+		size_t index = IndexOf(entity);
+		EntityID last = m_dense.Back();
+		m_removals.push_back({ entity, CurrentChangeTick() });
+
+		m_dense[index] = last;
+		m_changeTicks[index] = m_changeTicks.Back();
+		m_sparse[EntityID_Index(last) / PageSize][EntityID_Index(last) % PageSize] = index + 1;
+		m_sparse[EntityID_Index(entity) / PageSize][EntityID_Index(entity) % PageSize] = 0;
+		m_dense.PopBack();
+		m_changeTicks.PopBack();
+		return index;
+	}
+
+	const uint8_t* assignEntities(const uint8_t* data, size_t count)
+		// Replaces the dense array with EntityIDs copied from raw bytes, and rebuilds the sparse pages to match.  Every
+		// old entry is logged as removed, and every new entry is stamped as changed.
+	{
+		uint32_t tick = CurrentChangeTick();
+		for (size_t i = 0; i < m_dense.Size(); i++)
+		{
+			m_sparse[EntityID_Index(m_dense[i]) / PageSize][EntityID_Index(m_dense[i]) % PageSize] = 0;
+			m_removals.push_back({ m_dense[i], tick });
+		}
+		m_dense.AssignBytes(data, count);
+		while (m_changeTicks.Size() > count)
+		{
+			m_changeTicks.PopBack();
+		}
+		for (size_t i = 0; i < m_changeTicks.Size(); i++)
+		{
+			m_changeTicks[i] = tick;
+		}
+		while (m_changeTicks.Size() < count)
+		{
+			m_changeTicks.PushBack(tick);
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			size_t page = EntityID_Index(m_dense[i]) / PageSize;
+			if (page >= m_sparse.size())
+			{
+				m_sparse.resize(page + 1);
+			}
+			if (!m_sparse[page])
+			{
+				m_sparse[page] = std::make_unique<size_t[]>(PageSize);
+			}
+			m_sparse[page][EntityID_Index(m_dense[i]) % PageSize] = i + 1;
+		}
+		return data + count * sizeof(EntityID);
+	}
+
+	void clearEntities()
+	{
+		uint32_t tick = CurrentChangeTick();
+		for (size_t i = 0; i < m_dense.Size(); i++)
+		{
+			m_sparse[EntityID_Index(m_dense[i]) / PageSize][EntityID_Index(m_dense[i]) % PageSize] = 0;
+			m_removals.push_back({ m_dense[i], tick });
+		}
+		m_dense.Clear();
+		m_changeTicks.Clear();
+	}
+
+	static constexpr size_t PageSize = 1024;
+
+	struct Removal
+	{
+		EntityID entity;
+		uint32_t tick;
+	};
+
+	// Each sparse entry holds (dense index + 1), so that zero-initialized pages read as empty.
+	std::vector<std::unique_ptr<size_t[]>> m_sparse;
+	ChunkedArray<EntityID> m_dense;
+	ChunkedArray<uint32_t> m_changeTicks; // Parallel to m_dense
+	std::vector<Removal> m_removals; // In order of removal, so ticks are ascending
+};
+
+/// A packed container associating EntityIDs with values of type @c T.
+/// @tparam T The type of value stored for each entity.  Must be default-constructible.
+/// @remarks Values are stored in a dense array parallel to the dense EntityID array of SparseSetBase.
+template <typename T>
+class SparseSet : public SparseSetBase
+{
+public:
+	/// Get the value associated with an entity.
+	/// @param entity The EntityID to look up.
+	/// @return A reference to the entity's value.
+	/// @pre @c entity must have an entry in the set.
+	inline T& Get(EntityID entity) { return m_values[IndexOf(entity)]; }
+	/// Get the value associated with an entity.
+	/// @param entity The EntityID to look up.
+	/// @return A reference to the entity's value.
+	/// @pre @c entity must have an entry in the set.
+	inline const T& Get(EntityID entity) const { return m_values[IndexOf(entity)]; }
+
+	/// Get the value associated with an entity, if it exists.
+	/// @param entity The EntityID to look up.
+	/// @return A pointer to the entity's value, or @c nullptr if @c entity has no entry.
+	inline T* TryGet(EntityID entity) { return Contains(entity) ? &m_values[IndexOf(entity)] : nullptr; }
+
+	/// Add an entry for an entity.
+	/// @param entity The EntityID to add.
+	/// @param value The value to associate with @c entity.
+	/// @return A reference to the stored value.
+	/// @pre @c entity must not already have an entry in the set.
+	T& Insert(EntityID entity, const T& value)
+	{
+		insertEntity(entity);
+		return m_values.PushBack(value);
+	}
+
+	/// Remove an entity's entry.
+	/// @param entity The EntityID to remove.
+	/// @return The dense position that was vacated.  The last entry is moved into this position, so any arrays kept
+	/// in parallel with the dense array should perform the same move.
+	/// @pre @c entity must have an entry in the set.
+	size_t Erase(EntityID entity)
+	{
+		size_t index = eraseEntity(entity);
+		m_values[index] = std::move(m_values.Back());
+		m_values.PopBack();
+		return index;
+	}
+
+	/// Remove the entries of many entities at once.
+	/// @tparam MoveFn Callable as @c onMove(size_t from, size_t to).
+	/// @param entities Pointer to an array of EntityIDs to remove.  IDs without an entry are ignored.
+	/// @param count The number of IDs in @c entities.
+	/// @param onMove Called for every remaining entry that is moved to a new dense position, so that arrays kept in
+	/// parallel with the dense array can perform the same move.  Afterwards, parallel arrays should be truncated to
+	/// Size().
+	/// @return The number of entries removed.
+	/// @remarks Small batches are swap-removed one at a time.  Large batches are removed with a single compacting
+	/// pass over the dense arrays, which keeps the remaining entries in order.
+	template <typename MoveFn>
+	size_t EraseBatch(const EntityID* entities, size_t count, MoveFn onMove)
+	{
+		size_t oldSize = Size();
+		if (count * 4 < oldSize)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				if (Contains(entities[i]))
+				{
+					size_t index = Erase(entities[i]);
+					if (index != Size())
+					{
+						onMove(Size(), index);
+					}
+				}
+			}
+			return oldSize - Size();
+		}
+
+		// Clear the dense entry of each removed entity.  EntityID 0 is never valid, so it marks the gap.
+		uint32_t tick = CurrentChangeTick();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (Contains(entities[i]))
+			{
+				m_removals.push_back({ entities[i], tick });
+				m_dense[IndexOf(entities[i])] = 0;
+				m_sparse[EntityID_Index(entities[i]) / PageSize][EntityID_Index(entities[i]) % PageSize] = 0;
+			}
+		}
+
+		size_t write = 0;
+		for (size_t read = 0; read < oldSize; read++)
+		{
+			EntityID entity = m_dense[read];
+			if (entity == 0)
+				continue;
+
+			if (read != write)
+			{
+				m_dense[write] = entity;
+				m_changeTicks[write] = m_changeTicks[read];
+				m_values[write] = std::move(m_values[read]);
+				m_sparse[EntityID_Index(entity) / PageSize][EntityID_Index(entity) % PageSize] = write + 1;
+				onMove(read, write);
+			}
+			write++;
+		}
+		while (m_dense.Size() > write)
+		{
+			m_dense.PopBack();
+			m_changeTicks.PopBack();
+			m_values.PopBack();
+		}
+		return oldSize - write;
+	}
+
+	/// Remove all entries.
+	void Clear()
+	{
+		clearEntities();
+		m_values.Clear();
+	}
+
+	/// Append a copy of the set's contents to a buffer.
+	/// @param outData The buffer to append to.
+	/// @remarks Only available for trivially copyable value types.  The dense arrays are copied chunk by chunk, so
+	/// this runs at memory speed.
+	void AppendBytes(std::vector<uint8_t>& outData) const
+	{
+		uint64_t size = Size();
+		const uint8_t* sizeBytes = reinterpret_cast<const uint8_t*>(&size);
+		outData.insert(outData.end(), sizeBytes, sizeBytes + sizeof(size));
+		m_dense.AppendBytes(outData);
+		m_values.AppendBytes(outData);
+	}
+	/// Replace the set's contents with a copy written by AppendBytes().
+	/// @param data Pointer to the start of the copy.
+	/// @return Pointer to the first byte after the copy.
+	/// @remarks Existing storage is reused, so restoring a set of similar size does not allocate.
+	const uint8_t* AssignBytes(const uint8_t* data)
+	{
+		uint64_t size;
+		std::memcpy(&size, data, sizeof(size));
+		data = assignEntities(data + sizeof(size), size_t(size));
+		m_values.AssignBytes(data, size_t(size));
+		return data + size * sizeof(T);
+	}
+
+	/// Preallocate the dense arrays.
+	/// @param capacity The number of entries to reserve space for.
+	void Reserve(size_t capacity)
+	{
+		m_dense.Reserve(capacity);
+		m_changeTicks.Reserve(capacity);
+		m_values.Reserve(capacity);
+	}
+
+	/// Get the value at a dense array position.
+	/// @param index The dense position, in [0, Size()).
+	/// @return A reference to the value stored at @c index.
+	inline T& ValueAt(size_t index) { return m_values[index]; }
+	/// Get the value at a dense array position.
+	/// @param index The dense position, in [0, Size()).
+	/// @return A reference to the value stored at @c index.
+	inline const T& ValueAt(size_t index) const { return m_values[index]; }
+
+	/// Get the dense array of values.
+	/// @return The dense value array, in the same order as Entities().
+	inline ChunkedArray<T>& Values() { return m_values; }
+	/// Get the dense array of values.
+	/// @return The dense value array, in the same order as Entities().
+	inline const ChunkedArray<T>& Values() const { return m_values; }
+
+private:
+	ChunkedArray<T> m_values;
+};
+
+}
@@ -23,6 +23,13 @@ class Renderer2D
 {
 public:
 
+	/// A sprite component.  Attaches a textured quad to an entity.
+	struct SpriteComponent
+	{
+		Graphics::TextureHandle tex;
+		float uv_bounds[4]; // l, r, b, t
+	};
+
 	/// Start a new sprite batch.
 	EP_API static void BeginBatch();
 	/// Render a new sprite as part of a sprite batch.
@@ -37,6 +44,16 @@ public:
 	EP_API static void DrawSprite(Graphics::TextureHandle texture,
 		float uv_l, float uv_r, float uv_b, float uv_t,
 		glm::vec3 position, glm::quat rotation, glm::vec2 scale);
+	/// Render a new sprite as part of a sprite batch.
+	/// @param texture The handle of the sprite's associated texture.
+	/// @param uv_l The x-coordinate of the left edge of the texture sample region.
+	/// @param uv_r The x-coordinate of the right edge of the texture sample region.
+	/// @param uv_b The y-coordinate of the bottom edge of the texture sample region.
+	/// @param uv_t The y-coordinate of the top edge of the texture sample region.
+	/// @param transform The matrix transforming the unit sprite quad into world coordinates.
+	EP_API static void DrawSprite(Graphics::TextureHandle texture,
+		float uv_l, float uv_r, float uv_b, float uv_t,
+		const glm::mat4& transform);
 	/// End a sprite batch and draw it to the screen.
 	EP_API static void EndBatch();
 
@@ -54,9 +71,17 @@ public:
 	/// Delete any sprite component associated with an entity.
 	/// @param entity The ID of the entity to delete components from.
 	EP_API static void DeleteSpriteComponent(EntityID entity);
+	/// Delete the sprite components associated with many entities.
+	/// @param entities Pointer to an array of the IDs of the entities to delete components from.
+	/// @param count The number of IDs in @c entities.
+	EP_API static void DeleteSpriteComponents(const EntityID* entities, size_t count);
 	/// Get a list of entities with a sprite component attached.
 	/// @return A vector of EntityIDs currently associated with a sprite component.
 	EP_API static std::vector<EntityID> GetEntitiesWithSpriteComponents();
+	/// Check whether an entity has a sprite component attached.
+	/// @param entity The ID of the entity to check.
+	/// @return @c true if the entity has a sprite component.
+	EP_API static bool HasSpriteComponent(EntityID entity);
 	/// Write out sprite component data for an entity in YAML format.
 	/// @param entity The ID of the entity to serialize sprite components for.
 	/// @param yamlOut A YAML node to receive the serialized sprite component data.
@@ -67,19 +92,37 @@ public:
 	/// @param yamlIn A YAML node containing the serialized sprite component data.
 	/// @return @c true if deserialization was successful.
 	EP_API static bool DeserializeSpriteComponent(EntityID entity, const YAML::Node& yamlIn);
+	/// Write out sprite component data for an entity in binary format.
+	/// @param entity The ID of the entity to serialize sprite components for.
+	/// @param outData A buffer to append the serialized sprite component data to.
+	/// @return @c true if serialization was successful.
+	EP_API static bool SerializeSpriteComponentBinary(EntityID entity, std::vector<uint8_t>& outData);
+	/// Instantiate a sprite component serialized in binary format.
+	/// @param entity The ID of the entity to attach the loaded sprite component to.
+	/// @param data Pointer to the serialized sprite component data.
+	/// @param size The size of the serialized data in bytes.
+	/// @return @c true if deserialization was successful.
+	EP_API static bool DeserializeSpriteComponentBinary(EntityID entity, const uint8_t* data, size_t size);
+	/// Append the state of every sprite component to a scene snapshot.
+	/// @param outData A buffer to append the sprite component state to.
+	/// @remarks Every texture used by a sprite component is retained until ReleaseSpriteSnapshot() is invoked.
+	EP_API static void SaveSpriteSnapshot(std::vector<uint8_t>& outData);
+	/// Replace every sprite component with the state stored in a scene snapshot.
+	/// @param data Pointer to the state written by SaveSpriteSnapshot().
+	/// @param size The size of the state in bytes.
+	EP_API static void RestoreSpriteSnapshot(const uint8_t* data, size_t size);
+	/// Release the textures retained by a scene snapshot.
+	/// @param data Pointer to the state written by SaveSpriteSnapshot().
+	/// @param size The size of the state in bytes.
+	EP_API static void ReleaseSpriteSnapshot(const uint8_t* data, size_t size);
 
 	/// Initialize Renderer2D.
 	/// @param maxSpriteComponents The maximum number of sprite components to support.
 	EP_API static void Init(size_t maxSpriteComponents);
 
 private:
-	struct SpriteComponent
-	{
-		EntityID id;
-		Graphics::TextureHandle tex;
-		float uv_bounds[4]; // l, r, b, t
-	};
-	static std::vector<SpriteComponent> spriteComponents;
+	static SparseSet<SpriteComponent> spriteComponents;
+	static size_t maxSpriteComponents;
 	static std::vector<TextureFilter> minFilters;
 	static std::vector<TextureFilter> magFilters;
 	static std::vector<MipmapMode> mipModes;
@@ -9,8 +9,27 @@ namespace Constants::Time
 {
 constexpr double FixedTimestep = 1.0 / 240.0;
 constexpr double MaxFrameDelta = 1.0 / 15.0;
+/// The default maximum number of fixed timesteps simulated in one frame.
+/// @remarks Enough steps to simulate a whole MaxFrameDelta, so by default frames are never cut short before the frame
+/// delta clamp applies.  Projects can lower it with the @c Time/MaxFixedSubsteps key in their project file.
+constexpr unsigned int DefaultMaxFixedSubsteps = 16;
+static_assert(DefaultMaxFixedSubsteps * FixedTimestep >= MaxFrameDelta * (1.0 - 1e-9),
+	"Constants::Time::DefaultMaxFixedSubsteps must cover MaxFrameDelta / FixedTimestep steps.");
+/// The default maximum game time carried over to later frames under FixedCatchUpPolicy::CarryOver, in seconds.
+/// @remarks Projects can override this with the @c Time/MaxTimeDebt key in their project file.
+constexpr double DefaultMaxTimeDebt = 1.0 / 15.0;
+/// The default upper limit of the variable fixed timestep, in seconds.
+/// @remarks Projects can override this with the @c Time/MaxFixedTimestep key in their project file.
+constexpr double DefaultMaxFixedTimestep = 1.0 / 30.0;
 }
 
+/// What happens to unsimulated game time when a frame reaches its fixed timestep limit.
+enum class FixedCatchUpPolicy
+{
+	Drop,		// Unsimulated time beyond the current fixed timestep is discarded.  The game slows down under load.
+	CarryOver	// Unsimulated time is simulated in later frames, up to a limit.  Excess time is discarded.
+};
+
 
 /// The Enterprise time system.
 class Time
@@ -35,7 +54,7 @@ public:
 	EP_API static float RealDelta();
 	/// Get the number of game seconds that have passed since the previous frame.
 	/// @return The number of game-world seconds that have passed since the previous frame.
-	/// @note If called from FixedUpdate(), this value always equals Constants::Time::FixedTimestep.
+	/// @note If called from FixedUpdate(), this value always equals FixedTimestep().
 	EP_API static float GameDelta();
 
 	/// Get the number of real seconds that have not yet been processed by FixedUpdate().
@@ -60,9 +79,56 @@ public:
 	/// @remarks The game world runs twice as fast when the time scale is set to @c 2.0, and half as fast when set to @c 0.5.
 	EP_API static void SetTimeScale(double scalar);
 
+	/// Get the length of the fixed timestep.
+	/// @return The number of game seconds simulated by each FixedUpdate().
+	/// @remarks This is Constants::Time::FixedTimestep unless the variable fixed timestep is enabled.
+	EP_API static float FixedTimestep();
+
+	/// Limit the number of fixed timesteps simulated in one frame.
+	/// @param maxSubsteps The maximum number of FixedUpdate() calls per frame.  Must be at least 1.
+	/// @remarks When a frame falls further behind than this, the remaining time is handled by the catch-up policy.
+	/// Without a limit, a slow frame causes more fixed updates, which make the next frame slower still.
+	EP_API static void SetMaxFixedSubsteps(unsigned int maxSubsteps);
+	/// Set what happens to unsimulated game time when a frame reaches the fixed timestep limit.
+	/// @param policy The catch-up policy.
+	/// @param maxTimeDebt Under FixedCatchUpPolicy::CarryOver, the most game time that can be carried over, in seconds.
+	/// @remarks The default policy is FixedCatchUpPolicy::Drop.  Projects can set it with the @c Time/FixedCatchUp key
+	/// ("Drop" or "CarryOver") in their project file.
+	EP_API static void SetFixedCatchUpPolicy(FixedCatchUpPolicy policy,
+		double maxTimeDebt = Constants::Time::DefaultMaxTimeDebt);
+	/// Enable or disable the variable fixed timestep.
+	/// @param enabled Whether the fixed timestep may lengthen under load.
+	/// @param maxTimestep The longest allowed fixed timestep, in seconds.
+	/// @remarks When enabled, the fixed timestep doubles whenever a frame reaches the fixed timestep limit, up to
+	/// @c maxTimestep.  It halves again, down to Constants::Time::FixedTimestep, once fixed updates have used less than
+	/// a quarter of the frame time for a while.  Projects can enable it with the @c Time/VariableFixedTimestep key in
+	/// their project file.
+	EP_API static void SetVariableFixedTimestep(bool enabled,
+		double maxTimestep = Constants::Time::DefaultMaxFixedTimestep);
+
+	/// Statistics about fixed timestep processing.
+	struct FixedUpdateStats
+	{
+		uint64_t totalSteps; // Fixed updates since launch
+		unsigned int stepsLastFrame; // Fixed updates in the most recent frame
+		uint64_t throttledFrames; // Frames which reached the fixed timestep limit
+		double droppedGameTime; // Game seconds discarded by the catch-up policy since launch
+		double timeDebt; // Unsimulated game seconds carried into the current frame
+		double fixedTimestep; // The current fixed timestep, in game seconds
+	};
+	/// Get statistics about fixed timestep processing.
+	/// @return Statistics current to the start of the most recent Update().
+	EP_API static FixedUpdateStats GetFixedUpdateStats();
+
+	/// Get the number of frames that have started since application launch.
+	/// @return The number of the current frame.  The first frame is frame 1.
+	/// @remarks Before the first frame starts, and between frames, this is the number of the most recent frame.
+	EP_API static uint64_t FrameCount();
+
 private:
 	friend class Runtime;
 	friend class Input;
+	friend class Events;
 
 	static void Init();
 	static void PlatformInit();
@@ -74,6 +140,14 @@ private:
 
 	static void Update();
 	static bool ProcessFixedUpdate();
+	static void UpdateFixedTimestepTicks();
+	static void ApplyCatchUpPolicy();
+	static void AdaptFixedTimestep(bool throttled);
+
+	// Special access for event trace recording and replay
+	static uint64_t FrameTicks();
+	static double FrameFixedTimestep();
+	static void SetReplayFrame(uint64_t realTicks, double timestep);
 
 	// Special access for values needed by the Input system
 	static float ActualRealDelta();
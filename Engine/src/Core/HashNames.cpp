@@ -1,23 +1,124 @@
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
 #include "Enterprise/Core/HashNames.h"
 #include "Enterprise/Core.h"
 
-static std::unordered_map<HashName, std::string> HashNameTable;
-
 #ifdef EP_CONFIG_DEBUG
 
-HashName HN(const char* stringname, size_t length)
+// The string table is split into shards by hash, each with its own lock, so that threads hashing different names
+// rarely wait on each other.  Lookups of names already in the table only take a shared lock.
+constexpr size_t HashNameShardCount = 16;
+constexpr size_t HashNameArenaBlockSize = 64 * 1024;
+
+// Stores the strings of one shard in large blocks, so that each name costs no separate heap allocation.  Strings
+// are never freed or moved until exit, so views into the arena stay valid.
+class HashNameArena
 {
-	HashName hash = CTSpookyHash::Hash64(stringname, length, 0);
+public:
+	std::string_view Store(const char* string, size_t length)
+	{
+		if (length > m_remaining)
+		{
+			size_t blockSize = std::max(length, HashNameArenaBlockSize);
+			m_blocks.emplace_back(std::make_unique<char[]>(blockSize));
+			m_next = m_blocks.back().get();
+			m_remaining = blockSize;
+		}
+
+		char* stored = m_next;
+		std::memcpy(stored, string, length);
+		m_next += length;
+		m_remaining -= length;
+		return std::string_view(stored, length);
+	}
+
+private:
+	std::vector<std::unique_ptr<char[]>> m_blocks;
+	char* m_next = nullptr;
+	size_t m_remaining = 0;
+};
+
+struct HashNameShard
+{
+	std::shared_mutex mutex;
+	std::unordered_map<HashName, std::string_view> names;
+	HashNameArena arena;
+};
+
+static HashNameShard* hashNameShards()
+	// Helper function: gets the shards of the string table.  HN_CONSTANT()s in other files use them during static
+	// initialization, so they are constructed on first use.
+{
+	static HashNameShard shards[HashNameShardCount];
+	return shards;
+}
+
+static inline HashNameShard& shardOf(HashName hash)
+	// Helper function: gets the shard holding a hash.  The low bits are used for buckets within the shard.
+{
+	return hashNameShards()[(hash >> 56) % HashNameShardCount];
+}
+
+static bool internName(HashName hash, const char* stringname, size_t length, std::string* outCollision)
+	// Helper function: adds a string to the table.  Returns false, and the string it collided with, if a different
+	// string with the same hash is already there.
+{
+	std::string_view name(stringname, length);
+	HashNameShard& shard = shardOf(hash);
+
+	{
+		std::shared_lock<std::shared_mutex> lock(shard.mutex);
+		auto it = shard.names.find(hash);
+		if (it != shard.names.end())
+		{
+			if (it->second == name)
+				return true;
+			*outCollision = std::string(it->second);
+			return false;
+		}
+	}
 
-	std::unordered_map<HashName, std::string>::iterator it = HashNameTable.find(hash);
-	if (it == HashNameTable.end())
+	// Another thread may have added the name since the shared lock was released, so check again
+	std::unique_lock<std::shared_mutex> lock(shard.mutex);
+	auto it = shard.names.find(hash);
+	if (it == shard.names.end())
 	{
-		HashNameTable[hash] = std::string(stringname, length);
+		shard.names.emplace(hash, shard.arena.Store(stringname, length));
+		return true;
 	}
-	else
+	else if (it->second == name)
 	{
-		// TODO: Display the string name in the assertion failure, once EP_ASSERTF is fixed.
-		EP_ASSERTF(std::string(stringname, length) == it->second, "Hash collision detected!");
+		return true;
+	}
+	*outCollision = std::string(it->second);
+	return false;
+}
+
+// Collisions found before logging is available, reported by HN_CheckStaticRegistry()
+static std::mutex staticCollisionsMutex;
+static std::vector<std::pair<std::string, std::string>>& staticCollisions()
+{
+	static std::vector<std::pair<std::string, std::string>> collisions;
+	return collisions;
+}
+static std::atomic<bool> staticRegistryChecked = false;
+
+// HN_NULL is a literal, so the empty string is registered here for HN_ToStr()
+[[maybe_unused]] static const bool nullNameRegistered = HN_RegisterStatic("", 0);
+
+HashName HN(const char* stringname, size_t length)
+{
+	HashName hash = CTSpookyHash::Hash64(stringname, length, 0);
+
+	std::string collision;
+	if (!internName(hash, stringname, length, &collision))
+	{
+		EP_ERROR("Hash collision detected between \"{}\" and \"{}\"!", collision, std::string(stringname, length));
+		EP_ASSERTF(false, "Hash collision detected!");
 	}
 
 	return hash;
@@ -30,33 +131,100 @@ HashName HN(const char* stringname)
 
 HashName HN(std::string stringname)
 {
-	HashName hash = CTSpookyHash::Hash64(stringname.c_str(), stringname.size(), 0);
+	return HN(stringname.c_str(), stringname.size());
+}
 
-	std::unordered_map<HashName, std::string>::iterator it = HashNameTable.find(hash);
-	if (it == HashNameTable.end())
+std::string HN_ToStr(HashName hashname)
+{
+	HashNameShard& shard = shardOf(hashname);
 	{
-		HashNameTable[hash] = stringname;
+		std::shared_lock<std::shared_mutex> lock(shard.mutex);
+		auto it = shard.names.find(hashname);
+		if (it != shard.names.end())
+		{
+			return std::string(it->second);
+		}
 	}
-	else
+
+	EP_WARN("Can't unhash HashName \"{}\": was it hashed with HN()?", hashname);
+	return "";
+}
+
+bool HN_RegisterStatic(const char* stringname, size_t length)
+{
+	HashName hash = CTSpookyHash::Hash64(stringname, length, 0);
+
+	std::string collision;
+	if (!internName(hash, stringname, length, &collision))
 	{
-		// TODO: Display the string name in the assertion failure, once EP_ASSERTF is fixed.
-		EP_ASSERTF(stringname == it->second, "Hash collision detected!");
+		if (staticRegistryChecked)
+		{
+			EP_ERROR("Hash collision detected between \"{}\" and \"{}\"!", collision, std::string(stringname, length));
+			EP_ASSERTF(false, "Hash collision detected!");
+		}
+		else
+		{
+			// Logging is not set up during static initialization
+			std::lock_guard<std::mutex> lock(staticCollisionsMutex);
+			staticCollisions().emplace_back(std::move(collision), std::string(stringname, length));
+		}
 	}
 
-	return hash;
+	return true;
 }
 
-std::string HN_ToStr(HashName hashname)
+void HN_CheckStaticRegistry()
 {
-	if (HashNameTable.count(hashname))
+	staticRegistryChecked = true;
+
+	std::lock_guard<std::mutex> lock(staticCollisionsMutex);
+	for (const auto& [first, second] : staticCollisions())
 	{
-		return HashNameTable.at(hashname);
+		EP_ERROR("Hash collision detected between \"{}\" and \"{}\"!", first, second);
 	}
-	else
+	EP_ASSERTF(staticCollisions().empty(), "Hash collision detected!");
+}
+
+bool HN_SaveTable(const std::string& nativePath)
+{
+	// Sorted by hash, so that tables from different runs can be compared
+	std::vector<std::pair<HashName, std::string>> entries;
+	for (size_t i = 0; i < HashNameShardCount; i++)
 	{
-		EP_WARN("Can't unhash HashName \"{}\": was it hashed with HN()?", hashname);
-		return "";
+		std::shared_lock<std::shared_mutex> lock(hashNameShards()[i].mutex);
+		for (const auto& [hash, name] : hashNameShards()[i].names)
+		{
+			entries.emplace_back(hash, std::string(name));
+		}
 	}
+	std::sort(entries.begin(), entries.end());
+
+	std::ofstream file(nativePath, std::ios_base::out | std::ios_base::trunc);
+	if (!file)
+	{
+		EP_ERROR("HN_SaveTable(): Could not open \"{}\" for writing.", nativePath);
+		return false;
+	}
+
+	// One "hash<TAB>string" line per name.  Backslashes, tabs, and line breaks in names are escaped.
+	for (const auto& [hash, name] : entries)
+	{
+		file << std::hex << std::setw(16) << std::setfill('0') << hash << '\t';
+		for (char c : name)
+		{
+			switch (c)
+			{
+			case '\\': file << "\\\\"; break;
+			case '\t': file << "\\t"; break;
+			case '\n': file << "\\n"; break;
+			case '\r': file << "\\r"; break;
+			default: file << c; break;
+			}
+		}
+		file << '\n';
+	}
+
+	return bool(file);
 }
 
 #endif
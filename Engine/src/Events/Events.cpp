@@ -1,19 +1,29 @@
+#include <mutex>
+#include <unordered_set>
 #include "Enterprise/Events.h"
+#include "Enterprise/Time.h"
+#include "Enterprise/File.h"
+#include "Enterprise/Runtime.h"
 
 using Enterprise::Events;
 using Enterprise::StateManager;
+using Enterprise::Time;
+using Enterprise::File;
 
-std::unordered_map<HashName, std::list<std::pair<Events::EventCallbackPtr, std::weak_ptr<StateManager::State>>>> Events::callbackPtrs;
+std::unordered_map<HashName, Events::ChannelData> Events::eventTypes;
+std::unordered_map<HashName, Events::ChannelData> Events::channels;
 
 Events::EventCallbackPtr Events::Subscribe(HashName type, EventCallbackPtr callback)
 {
+	ChannelData& subscribers = eventTypes[type];
+
 	#ifdef EP_CONFIG_DEBUG
 
 	// For every callback already registered for this type...
-	for (auto it = callbackPtrs[type].begin(); it != callbackPtrs[type].end(); ++it)
+	for (const ChannelSubscriber& subscriber : subscribers.subscribers)
 	{
 		// ...check that it isn't the callback we're trying to register.
-		if (it->first == callback)
+		if (subscriber.callback == reinterpret_cast<ErasedCallbackPtr>(callback))
 		{
 			EP_WARN("Events: Duplicate subscription to single event type on a callback.  "
 					"\nType: {}", HN_ToStr(type));
@@ -23,7 +33,7 @@ Events::EventCallbackPtr Events::Subscribe(HashName type, EventCallbackPtr callb
 
 	#endif
 	
-	callbackPtrs[type].emplace_back(std::pair(callback, StateManager::activeState));
+	subscribers.subscribers.push_back({ reinterpret_cast<ErasedCallbackPtr>(callback), StateManager::activeState });
 	return callback;
 }
 
@@ -37,30 +47,58 @@ void Events::Subscribe(std::initializer_list<HashName> types, EventCallbackPtr c
 
 void Events::Unsubscribe(HashName type, EventCallbackPtr callback)
 {
-	for (auto it = callbackPtrs[type].begin(); it != callbackPtrs[type].end(); )
+	auto subscribers = eventTypes.find(type);
+	if (subscribers != eventTypes.end())
+	{
+		unsubscribeChannel(subscribers->second, subscribers->second.subscribers,
+			reinterpret_cast<ErasedCallbackPtr>(callback));
+	}
+}
+
+void Events::dispatchToSubscribers(ChannelData& subscribers, Event& e)
+{
+	subscribers.dispatchDepth++;
+
+	// Call each registered callback until one returns true.  Indexed from the back, so that callbacks may subscribe
+	// and unsubscribe during dispatch.
+	for (size_t i = subscribers.subscribers.size(); i-- > 0; )
 	{
-		if (it->first == callback)
+		EventCallbackPtr callback = reinterpret_cast<EventCallbackPtr>(subscribers.subscribers[i].callback);
+		if (!callback)
+			continue; // Unsubscribed during this dispatch
+
+		bool willBreak;
+		if (sameState(subscribers.subscribers[i].state, StateManager::activeState))
 		{
-			it = callbackPtrs[type].erase(it);
-			break;
+			willBreak = callback(e);
 		}
 		else
-			it++;
+		{
+			std::weak_ptr<StateManager::State> prevActiveState = StateManager::activeState;
+			StateManager::activeState = subscribers.subscribers[i].state;
+			willBreak = callback(e);
+			StateManager::activeState = prevActiveState;
+		}
+		if (willBreak) break;
+	}
+
+	subscribers.dispatchDepth--;
+	if (subscribers.dispatchDepth == 0 && subscribers.hasRemovals)
+	{
+		compactChannel(subscribers);
 	}
 }
 
 void Events::Dispatch(Event& e)
 {
-	// Call each registered callback until one returns true
-	for (auto callbackit = callbackPtrs[e.Type()].rbegin();
-		 callbackit != callbackPtrs[e.Type()].rend();
-		 ++callbackit)
+	if (traceState != TraceState::Off && !traceEvent(e))
+		return;
+
+	// Looked up without operator[], so dispatching never inserts into the map
+	auto subscribers = eventTypes.find(e.Type());
+	if (subscribers != eventTypes.end())
 	{
-		std::weak_ptr<StateManager::State> prevActiveState = StateManager::activeState;
-		StateManager::activeState = callbackit->second;
-		bool willBreak = callbackit->first(e);
-		StateManager::activeState = prevActiveState;
-		if (willBreak) break;
+		dispatchToSubscribers(subscribers->second, e);
 	}
 }
 
@@ -68,16 +106,482 @@ void Events::Dispatch(HashName type)
 {
 	// Generate the event
 	Events::Event e = type;
+	Dispatch(e);
+}
+
+Events::EventSlot Events::GetEventSlot(HashName type)
+{
+	return EventSlot(type, &eventTypes[type]);
+}
+
+void Events::Dispatch(EventSlot slot)
+{
+	Events::Event e = slot.m_type;
+	if (traceState != TraceState::Off && !traceEvent(e))
+		return;
+	dispatchToSubscribers(*slot.m_data, e);
+}
+
+
+Events::ChannelData& Events::getChannel(HashName typeID)
+{
+	// Channels can be first used from any thread that posts to them
+	static std::mutex channelsMutex;
+	std::lock_guard<std::mutex> lock(channelsMutex);
+	return channels[typeID];
+}
+
+void Events::subscribeChannel(std::vector<ChannelSubscriber>& list, ErasedCallbackPtr callback)
+{
+	#ifdef EP_CONFIG_DEBUG
 
-	// Call each registered callback until one returns true
-	for (auto callbackit = callbackPtrs[type].rbegin();
-		 callbackit != callbackPtrs[type].rend();
-		 ++callbackit)
+	for (const ChannelSubscriber& subscriber : list)
 	{
-		std::weak_ptr<StateManager::State> prevActiveState = StateManager::activeState;
-		StateManager::activeState = callbackit->second;
-		bool willBreak = callbackit->first(e);
-		StateManager::activeState = prevActiveState;
-		if (willBreak) break;
+		if (subscriber.callback == callback)
+		{
+			EP_WARN("Events: Duplicate subscription to a channel on a callback.");
+			EP_DEBUGBREAK();
+		}
+	}
+
+	#endif
+
+	list.push_back({ callback, StateManager::activeState });
+}
+
+void Events::unsubscribeChannel(ChannelData& channel, std::vector<ChannelSubscriber>& list,
+	ErasedCallbackPtr callback)
+{
+	for (auto it = list.begin(); it != list.end(); ++it)
+	{
+		if (it->callback == callback)
+		{
+			if (channel.dispatchDepth == 0)
+			{
+				list.erase(it);
+			}
+			else
+			{
+				// Removing now would shift the subscribers being iterated
+				it->callback = nullptr;
+				it->state.reset();
+				channel.hasRemovals = true;
+			}
+			break;
+		}
+	}
+}
+
+void Events::compactChannel(ChannelData& channel)
+{
+	auto isRemoved = [](const ChannelSubscriber& subscriber) { return subscriber.callback == nullptr; };
+	channel.subscribers.erase(std::remove_if(channel.subscribers.begin(), channel.subscribers.end(), isRemoved),
+		channel.subscribers.end());
+	channel.batchSubscribers.erase(
+		std::remove_if(channel.batchSubscribers.begin(), channel.batchSubscribers.end(), isRemoved),
+		channel.batchSubscribers.end());
+	channel.hasRemovals = false;
+}
+
+
+std::atomic<Events::ChannelData*> Events::queuedChannels[3] = {};
+
+void Events::queueChannel(ChannelData& channel)
+{
+	// Only the poster which set isQueued gets here, so each channel is in at most one stack
+	std::atomic<ChannelData*>& head = queuedChannels[size_t(channel.syncPoint)];
+	channel.nextQueued = head.load(std::memory_order_relaxed);
+	while (!head.compare_exchange_weak(channel.nextQueued, &channel,
+		std::memory_order_release, std::memory_order_relaxed));
+}
+
+void Events::DeliverPosted(SyncPoint point)
+{
+	// Take every queued channel at once, and reverse the stack so channels are delivered in the order first posted to
+	ChannelData* channel = queuedChannels[size_t(point)].exchange(nullptr, std::memory_order_acquire);
+	ChannelData* ordered = nullptr;
+	while (channel)
+	{
+		ChannelData* next = channel->nextQueued;
+		channel->nextQueued = ordered;
+		ordered = channel;
+		channel = next;
+	}
+
+	while (ordered)
+	{
+		channel = ordered;
+		ordered = ordered->nextQueued;
+
+		// Cleared first, so that events posted from now on queue the channel again for the next sync point.  This is
+		// a read-modify-write, so it is ordered with each poster's exchange: a poster that still sees the flag set
+		// pushed its event before this point, and the drain below is guaranteed to see it.
+		channel->isQueued.exchange(false, std::memory_order_acq_rel);
+		channel->deliverFn.load(std::memory_order_relaxed)(*channel);
+	}
+}
+
+
+// Event trace file layout.  The header is followed by a sequence of records, each beginning with a
+// TraceRecordHeader and padded to an 8-byte boundary.  Values are stored in native (little-endian) byte order.
+namespace
+{
+constexpr char TraceMagic[4] = { 'E', 'P', 'E', 'T' };
+constexpr uint32_t TraceVersion = 2; // Version 2 adds per-frame raw input records
+constexpr uint32_t TraceByteOrderMark = 0x01020304;
+
+struct TraceHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t byteOrderMark;
+	uint32_t reserved;
+	uint64_t tickFrequency; // Time ticks per second on the recording machine
+	uint64_t firstFrame; // Time::FrameCount() when recording started
+	uint64_t firstFixedStep; // Fixed updates completed when recording started
+};
+
+enum class TraceRecordType : uint32_t
+{
+	Frame,
+	Event
+};
+struct TraceRecordHeader
+{
+	TraceRecordType type;
+	uint32_t size; // Bytes following this header, including padding
+};
+
+// Written at the end of each frame
+struct TraceFrameRecord
+{
+	uint64_t frame;
+	uint64_t realTicks; // Length of the frame
+	double fixedTimestep; // Fixed timestep in effect during the frame
+};
+
+enum TraceEventFlags : uint32_t
+{
+	TraceEvent_External = 1 << 0, // Dispatched between frames, such as by the platform message pump
+	TraceEvent_HasData = 1 << 1 // The payload follows the record
+};
+struct TraceEventRecord
+{
+	uint64_t frame; // Time::FrameCount() at dispatch
+	uint64_t fixedStep; // Fixed updates completed at dispatch
+	HashName type;
+	HashName dataType;
+	uint32_t dataSize;
+	uint32_t flags;
+};
+}
+
+Events::TraceState Events::traceState = Events::TraceState::Off;
+std::unordered_map<HashName, Events::TraceTypeInfo> Events::traceTypes;
+
+static bool betweenFrames = false; // Events dispatched now come from outside the frame
+static bool tracingPolledState = false;
+static std::unordered_set<HashName> untracedEventTypes;
+HN_CONSTANT(quitRequestedEvent, "QuitRequested");
+
+static std::string recordingPath;
+static std::vector<uint8_t> recordingBuffer;
+
+static std::vector<uint8_t> replayData;
+static std::vector<const TraceEventRecord*> replayEvents; // External events, in order of dispatch
+static std::vector<const TraceFrameRecord*> replayFrames; // Indexed by frame, relative to the start of the trace
+static size_t replayCursor;
+static uint64_t replayFirstFrame, replayFirstFixedStep; // Frame and fixed step counts of this run at replay start
+static uint64_t traceFirstFrame, traceFirstFixedStep; // Frame and fixed step counts of the recording at its start
+static double replayTickScale; // This machine's tick frequency over the recording machine's
+static bool replayQuitWhenFinished, replayDiverged, isDispatchingReplay = false;
+static uint64_t replaySkippedEvents;
+
+static uint64_t currentFixedStep()
+	// Helper function: gets the number of fixed updates completed so far.
+{
+	return Time::GetFixedUpdateStats().totalSteps;
+}
+
+static void appendTraceRecord(TraceRecordType type, const void* record, size_t recordSize,
+	const void* data = nullptr, size_t dataSize = 0)
+	// Helper function: appends a record and its padded payload to the recording buffer.
+{
+	size_t paddedSize = (recordSize + dataSize + 7) & ~size_t(7);
+	TraceRecordHeader header = { type, uint32_t(paddedSize) };
+
+	size_t start = recordingBuffer.size();
+	recordingBuffer.resize(start + sizeof(TraceRecordHeader) + paddedSize, 0);
+	std::memcpy(recordingBuffer.data() + start, &header, sizeof(TraceRecordHeader));
+	std::memcpy(recordingBuffer.data() + start + sizeof(TraceRecordHeader), record, recordSize);
+	if (dataSize > 0)
+	{
+		std::memcpy(recordingBuffer.data() + start + sizeof(TraceRecordHeader) + recordSize, data, dataSize);
+	}
+}
+
+void Events::registerTraceType(HashName dataType, size_t size, TracePayloadFn payloadFn, TraceReplayFn replayFn)
+{
+	traceTypes[dataType] = { size, payloadFn, replayFn };
+}
+
+bool Events::traceEvent(Event& e)
+{
+	if (traceState == TraceState::Recording)
+	{
+		if (untracedEventTypes.count(e.m_type) != 0)
+			return true;
+
+		// Polled state is stamped with the previous frame, like the events which arrived before this one
+		TraceEventRecord record = { tracingPolledState ? Time::FrameCount() - 1 : Time::FrameCount(),
+			currentFixedStep(), e.m_type, e.m_dataType, 0,
+			betweenFrames || tracingPolledState ? uint32_t(TraceEvent_External) : 0u };
+		const void* data = nullptr;
+		if (e.m_dataType != 0)
+		{
+			auto typeInfo = traceTypes.find(e.m_dataType);
+			if (typeInfo != traceTypes.end())
+			{
+				data = typeInfo->second.payloadFn(e);
+				record.dataSize = uint32_t(typeInfo->second.size);
+				record.flags |= TraceEvent_HasData;
+			}
+		}
+		appendTraceRecord(TraceRecordType::Event, &record, sizeof(record), data, record.dataSize);
+		return true;
+	}
+
+	// Replaying.  Events generated by the simulation happen again on their own, but live events from outside the
+	// frame are replaced by the recorded ones.
+	return isDispatchingReplay || !betweenFrames || e.m_type == quitRequestedEvent;
+}
+
+void Events::tracePolledEvent(Event& e)
+{
+	tracingPolledState = true;
+	traceEvent(e);
+	tracingPolledState = false;
+}
+
+void Events::excludeFromTrace(HashName type)
+{
+	untracedEventTypes.insert(type);
+}
+
+bool Events::StartTraceRecording(const std::string& path)
+{
+	if (traceState != TraceState::Off)
+	{
+		EP_ERROR("Events::StartTraceRecording(): A trace is already being {}.",
+			traceState == TraceState::Recording ? "recorded" : "replayed");
+		return false;
+	}
+
+	recordingPath = path;
+	recordingBuffer.clear();
+
+	TraceHeader header = {};
+	std::memcpy(header.magic, TraceMagic, sizeof(TraceMagic));
+	header.version = TraceVersion;
+	header.byteOrderMark = TraceByteOrderMark;
+	header.tickFrequency = Time::SecondsToTicks(1.0);
+	header.firstFrame = Time::FrameCount();
+	header.firstFixedStep = currentFixedStep();
+	recordingBuffer.resize(sizeof(TraceHeader));
+	std::memcpy(recordingBuffer.data(), &header, sizeof(TraceHeader));
+
+	traceState = TraceState::Recording;
+	return true;
+}
+
+bool Events::StopTraceRecording()
+{
+	if (traceState != TraceState::Recording)
+		return false;
+	traceState = TraceState::Off;
+
+	File::ErrorCode ec = File::SaveBinaryFile(recordingPath, recordingBuffer.data(), recordingBuffer.size());
+	std::vector<uint8_t>().swap(recordingBuffer);
+	if (ec != File::ErrorCode::Success)
+	{
+		EP_ERROR("Events::StopTraceRecording(): Could not save \"{}\".  Error: {}",
+			recordingPath, File::ErrorCodeToStr(ec));
+		return false;
+	}
+	return true;
+}
+
+static void stopTraceReplay()
+	// Helper function: releases the loaded trace.
+{
+	std::vector<const TraceEventRecord*>().swap(replayEvents);
+	std::vector<const TraceFrameRecord*>().swap(replayFrames);
+	std::vector<uint8_t>().swap(replayData);
+}
+
+bool Events::StartTraceReplay(const std::string& path, bool quitWhenFinished)
+{
+	if (traceState != TraceState::Off)
+	{
+		EP_ERROR("Events::StartTraceReplay(): A trace is already being {}.",
+			traceState == TraceState::Recording ? "recorded" : "replayed");
+		return false;
+	}
+
+	{
+		File::MappedFile file(path);
+		if (file.GetLastError() != File::ErrorCode::Success)
+		{
+			EP_ERROR("Events::StartTraceReplay(): Could not open \"{}\".", path);
+			return false;
+		}
+		replayData.assign(file.Data(), file.Data() + file.Size());
+	}
+
+	TraceHeader header = {};
+	if (replayData.size() >= sizeof(TraceHeader))
+	{
+		std::memcpy(&header, replayData.data(), sizeof(TraceHeader));
 	}
+	if (std::memcmp(header.magic, TraceMagic, sizeof(TraceMagic)) != 0 ||
+		header.version != TraceVersion || header.byteOrderMark != TraceByteOrderMark)
+	{
+		EP_ERROR("Events::StartTraceReplay(): \"{}\" is not a compatible event trace.", path);
+		stopTraceReplay();
+		return false;
+	}
+
+	// Index the records.  Every record is 8-byte aligned within the file, and the buffer is suitably aligned.
+	size_t offset = sizeof(TraceHeader);
+	while (offset + sizeof(TraceRecordHeader) <= replayData.size())
+	{
+		const TraceRecordHeader* recordHeader = reinterpret_cast<const TraceRecordHeader*>(replayData.data() + offset);
+		offset += sizeof(TraceRecordHeader);
+		if (offset + recordHeader->size > replayData.size())
+		{
+			EP_WARN("Events::StartTraceReplay(): \"{}\" is truncated.  Only the complete records will be replayed.",
+				path);
+			break;
+		}
+
+		if (recordHeader->type == TraceRecordType::Frame && recordHeader->size >= sizeof(TraceFrameRecord))
+		{
+			const TraceFrameRecord* frame = reinterpret_cast<const TraceFrameRecord*>(replayData.data() + offset);
+			if (frame->frame >= header.firstFrame)
+			{
+				uint64_t index = frame->frame - header.firstFrame;
+				if (index >= replayFrames.size())
+				{
+					replayFrames.resize(index + 1, nullptr);
+				}
+				replayFrames[index] = frame;
+			}
+		}
+		else if (recordHeader->type == TraceRecordType::Event && recordHeader->size >= sizeof(TraceEventRecord))
+		{
+			const TraceEventRecord* event = reinterpret_cast<const TraceEventRecord*>(replayData.data() + offset);
+			if ((event->flags & TraceEvent_External) && event->frame >= header.firstFrame &&
+				sizeof(TraceEventRecord) + event->dataSize <= recordHeader->size)
+			{
+				replayEvents.push_back(event);
+			}
+		}
+		offset += recordHeader->size;
+	}
+
+	replayCursor = 0;
+	traceFirstFrame = header.firstFrame;
+	traceFirstFixedStep = header.firstFixedStep;
+	replayFirstFrame = Time::FrameCount();
+	replayFirstFixedStep = currentFixedStep();
+	replayTickScale = double(Time::SecondsToTicks(1.0)) / double(header.tickFrequency);
+	replayQuitWhenFinished = quitWhenFinished;
+	replayDiverged = false;
+	replaySkippedEvents = 0;
+
+	traceState = TraceState::Replaying;
+	return true;
+}
+
+bool Events::IsReplayingTrace()
+{
+	return traceState == TraceState::Replaying;
+}
+
+void Events::BeginTraceFrame()
+{
+	betweenFrames = false;
+	if (traceState != TraceState::Replaying)
+		return;
+
+	// Dispatch the events which arrived since the end of the previous recorded frame
+	uint64_t frame = Time::FrameCount() - replayFirstFrame;
+	isDispatchingReplay = true;
+	while (replayCursor < replayEvents.size() && replayEvents[replayCursor]->frame - traceFirstFrame <= frame)
+	{
+		const TraceEventRecord* event = replayEvents[replayCursor++];
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(event + 1);
+
+		// Replayed frames simulate the same number of fixed updates, so the counts only differ if replay went wrong
+		uint64_t recordedStep = event->fixedStep - traceFirstFixedStep;
+		uint64_t replayedStep = currentFixedStep() - replayFirstFixedStep;
+		if (!replayDiverged && recordedStep != replayedStep)
+		{
+			EP_WARN("Events: Trace replay has diverged from the recording at frame {}.  The recorded event was "
+				"dispatched after fixed update {}, but it is being replayed after fixed update {}.",
+				frame, recordedStep, replayedStep);
+			replayDiverged = true;
+		}
+
+		if (event->dataType == 0)
+		{
+			Dispatch(event->type);
+		}
+		else
+		{
+			auto typeInfo = traceTypes.find(event->dataType);
+			if ((event->flags & TraceEvent_HasData) && typeInfo != traceTypes.end() &&
+				typeInfo->second.size == event->dataSize)
+			{
+				typeInfo->second.replayFn(event->type, data);
+			}
+			else
+			{
+				replaySkippedEvents++;
+			}
+		}
+	}
+	isDispatchingReplay = false;
+
+	// Give the coming frame the timing of its recorded counterpart
+	if (frame + 1 < replayFrames.size() && replayFrames[frame + 1])
+	{
+		const TraceFrameRecord* next = replayFrames[frame + 1];
+		Time::SetReplayFrame(uint64_t(double(next->realTicks) * replayTickScale + 0.5), next->fixedTimestep);
+	}
+	else
+	{
+		EP_INFO("Events: Trace replay finished after {} frames.", frame);
+		if (replaySkippedEvents > 0)
+		{
+			EP_WARN("Events: {} events with unregistered payload types were not replayed.  Register their types "
+				"with Events::RegisterTraceType().", replaySkippedEvents);
+		}
+		traceState = TraceState::Off;
+		stopTraceReplay();
+		if (replayQuitWhenFinished)
+		{
+			Enterprise::Runtime::Quit();
+		}
+	}
+}
+
+void Events::EndTraceFrame()
+{
+	betweenFrames = true;
+	if (traceState != TraceState::Recording)
+		return;
+
+	TraceFrameRecord record = { Time::FrameCount(), Time::FrameTicks(), Time::FrameFixedTimestep() };
+	appendTraceRecord(TraceRecordType::Frame, &record, sizeof(record));
 }
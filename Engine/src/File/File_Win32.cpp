@@ -102,6 +102,120 @@ File::ErrorCode File::SaveTextFile(const std::string& path, const std::string& i
 	return ErrorCode::Success;
 }
 
+File::ErrorCode File::SaveBinaryFile(const std::string& path, const void* data, size_t size)
+{
+	std::string tempFileName = GetNewTempFilename();
+
+	FILE* fhandle = NULL;
+	errno_t err = fopen_s(&fhandle, tempFileName.c_str(), "wb");
+
+	if (err == 0)
+	{
+		fwrite(data, 1, size, fhandle);
+		fclose(fhandle);
+	}
+	else
+	{
+		char errormessage[1024];
+		strerror_s(errormessage, err);
+		EP_ERROR("File::SaveBinaryFile(): Error opening file. {}", errormessage);
+
+		if (errno == EACCES)
+			return ErrorCode::PermissionFailure;
+		if (errno == ENOENT)
+			return ErrorCode::DoesNotExist;
+		else
+			return ErrorCode::Unhandled;
+	}
+
+	if (MoveFileEx(UTF8toWCHAR(tempFileName).c_str(),
+				  UTF8toWCHAR(VirtualPathToNative(path)).c_str(),
+				  MOVEFILE_REPLACE_EXISTING) == 0)
+	{
+		EP_ERROR("File::SaveBinaryFile(): Error moving temp file to \"{}\"!  "
+			"Error: {}", VirtualPathToNative(path), Win32_LastErrorMsg());
+		return ErrorCode::Unhandled;
+	}
+
+	return ErrorCode::Success;
+}
+
+
+File::ErrorCode File::MappedFile::Open(const std::string& path)
+{
+	Close();
+	m_path = path;
+
+	HANDLE fileHandle = CreateFile(UTF8toWCHAR(VirtualPathToNative(path)).c_str(),
+		GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		DWORD err = ::GetLastError();
+		EP_ERROR("MappedFile::Open(): Error opening file \"{}\"!  Error: {}", path, Win32_LastErrorMsg());
+
+		if (err == ERROR_ACCESS_DENIED)
+			m_errorcode = ErrorCode::PermissionFailure;
+		else if (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND)
+			m_errorcode = ErrorCode::DoesNotExist;
+		else
+			m_errorcode = ErrorCode::Unhandled;
+		return m_errorcode;
+	}
+	m_fileHandle = fileHandle;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		EP_ERROR("MappedFile::Open(): Error reading size of \"{}\"!  Error: {}", path, Win32_LastErrorMsg());
+		Close();
+		m_errorcode = ErrorCode::Unhandled;
+		return m_errorcode;
+	}
+	m_size = size_t(fileSize.QuadPart);
+
+	// Empty files can't be mapped, but are still valid
+	if (m_size != 0)
+	{
+		m_mappingHandle = CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (m_mappingHandle)
+		{
+			m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		}
+
+		if (!m_data)
+		{
+			EP_ERROR("MappedFile::Open(): Error mapping file \"{}\"!  Error: {}", path, Win32_LastErrorMsg());
+			Close();
+			m_errorcode = ErrorCode::Unhandled;
+			return m_errorcode;
+		}
+	}
+
+	m_errorcode = ErrorCode::Success;
+	return m_errorcode;
+}
+
+void File::MappedFile::Close()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+	}
+	if (m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+	if (m_fileHandle)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = nullptr;
+	}
+	m_size = 0;
+}
+
+
 
 void File::TextFileWriter::Close()
 {
@@ -1,6 +1,8 @@
 #if defined(__APPLE__) && defined(__MACH__)
 
 #import <AppKit/AppKit.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "Enterprise/File.h"
 using Enterprise::File;
 
@@ -129,6 +131,136 @@ File::ErrorCode File::SaveTextFile(const std::string& path, const std::string& i
 	return ErrorCode::Success;
 }
 
+File::ErrorCode File::SaveBinaryFile(const std::string& path, const void* data, size_t size)
+{
+	std::string tempFileName = GetNewTempFilename();
+
+	FILE* fhandle = fopen(tempFileName.c_str(), "wb");
+
+	if (fhandle)
+	{
+		fwrite(data, 1, size, fhandle);
+		fclose(fhandle);
+	}
+	else
+	{
+		char errormessage[1024];
+		strerror_s(errormessage, errno);
+		EP_ERROR("File::SaveBinaryFile(): Error opening file. {}", errormessage);
+
+		if (errno == EACCES)
+			return ErrorCode::PermissionFailure;
+		if (errno == ENOENT)
+			return ErrorCode::DoesNotExist;
+		else
+			return ErrorCode::Unhandled;
+	}
+
+	@autoreleasepool
+	{
+		NSURL * tempFileURL = [NSURL fileURLWithFileSystemRepresentation:tempFileName.c_str()
+															 isDirectory:NO
+														   relativeToURL:nil];
+		NSURL * destFileURL = [NSURL fileURLWithFileSystemRepresentation:VirtualPathToNative(path).c_str()
+															 isDirectory:NO
+														   relativeToURL:nil];
+
+		NSError *error = nil;
+		BOOL moveResult = [[NSFileManager defaultManager] replaceItemAtURL:destFileURL
+															 withItemAtURL:tempFileURL
+															backupItemName:nil
+																   options:NSFileManagerItemReplacementUsingNewMetadataOnly
+														  resultingItemURL:nil
+																	 error:&error];
+
+		if (moveResult == NO)
+		{
+			std::string errorDesc = error.localizedDescription.UTF8String;
+			EP_ERROR("File::SaveBinaryFile(): Error moving temp file to \"{}\"!  "
+					 "Error: {}, {}", VirtualPathToNative(path), error.code, errorDesc);
+
+			if (error.code == EACCES)
+				return ErrorCode::PermissionFailure;
+			if (error.code == ENOENT)
+				return ErrorCode::DoesNotExist;
+			else
+				return ErrorCode::Unhandled;
+		}
+	}
+
+	return ErrorCode::Success;
+}
+
+
+File::ErrorCode File::MappedFile::Open(const std::string& path)
+{
+	Close();
+	m_path = path;
+
+	int fd = open(VirtualPathToNative(path).c_str(), O_RDONLY);
+	if (fd == -1)
+	{
+		char errormessage[1024];
+		strerror_s(errormessage, errno);
+		EP_ERROR("MappedFile::Open(): Error opening file \"{}\"!  Error: {}", path, errormessage);
+
+		if (errno == EACCES)
+			m_errorcode = ErrorCode::PermissionFailure;
+		else if (errno == ENOENT)
+			m_errorcode = ErrorCode::DoesNotExist;
+		else
+			m_errorcode = ErrorCode::Unhandled;
+		return m_errorcode;
+	}
+
+	struct stat fileInfo;
+	if (fstat(fd, &fileInfo) == -1)
+	{
+		char errormessage[1024];
+		strerror_s(errormessage, errno);
+		EP_ERROR("MappedFile::Open(): Error reading size of \"{}\"!  Error: {}", path, errormessage);
+		close(fd);
+		m_errorcode = ErrorCode::Unhandled;
+		return m_errorcode;
+	}
+	m_size = size_t(fileInfo.st_size);
+
+	// Empty files can't be mapped, but are still valid
+	if (m_size != 0)
+	{
+		void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			char errormessage[1024];
+			strerror_s(errormessage, errno);
+			EP_ERROR("MappedFile::Open(): Error mapping file \"{}\"!  Error: {}", path, errormessage);
+			close(fd);
+			m_size = 0;
+			m_errorcode = ErrorCode::Unhandled;
+			return m_errorcode;
+		}
+		madvise(mapping, m_size, MADV_SEQUENTIAL);
+		m_data = static_cast<const uint8_t*>(mapping);
+	}
+
+	// The mapping holds its own reference to the file
+	close(fd);
+
+	m_errorcode = ErrorCode::Success;
+	return m_errorcode;
+}
+
+void File::MappedFile::Close()
+{
+	if (m_data)
+	{
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+		m_data = nullptr;
+	}
+	m_size = 0;
+}
+
+
 
 void File::TextFileWriter::Close()
 {
@@ -8,8 +8,10 @@ using Enterprise::Graphics;
 
 // TODO: Overhaul this file with EP_WASSERT for warning checks.
 
-HashName Graphics::selectedShaderName = HN("EPNULLSHADER");
-HashName Graphics::activeShaderName = HN("EPNULLSHADER");
+HN_CONSTANT(nullShaderName, "EPNULLSHADER");
+
+HashName Graphics::selectedShaderName = nullShaderName;
+HashName Graphics::activeShaderName = nullShaderName;
 HashName Graphics::fallbackShaderName = HN_NULL;
 std::set<HashName> Graphics::selectedShaderOptions;
 std::set<HashName> Graphics::activeShaderOptions;
@@ -2327,8 +2329,8 @@ void Graphics::DeleteShader(HashName program)
 
 		if (activeShaderName == program)
 		{
-			activeShaderName = HN("EPNULLSHADER");
-			oglActiveProgram = oglShaderPrograms[HN("EPNULLSHADER")][{}];;
+			activeShaderName = nullShaderName;
+			oglActiveProgram = oglShaderPrograms[nullShaderName][{}];;
 		}
 	}
 }
@@ -2443,13 +2445,13 @@ void Graphics::BindShader(HashName program)
 		}
 		else
 		{
-			activeShaderName = HN("EPNULLSHADER");
+			activeShaderName = nullShaderName;
 			activeShaderOptions = {};
 			EP_WARN("Graphics::BindShader(): Unable to bind shader program and no fallback program has been set.  "
 				"Program: {}", HN_ToStr(program));
 			EP_DEBUGBREAK();
 
-			oglActiveProgram = oglShaderPrograms[HN("EPNULLSHADER")][{}];
+			oglActiveProgram = oglShaderPrograms[nullShaderName][{}];
 			EP_GL(glUseProgram(oglActiveProgram));
 		}
 	}
@@ -495,6 +495,15 @@ HashName Graphics::GetTextureHashedPath(TextureHandle texture)
 }
 
 
+void Graphics::RetainTexture(Graphics::TextureHandle texture)
+{
+	EP_ASSERT(texture);
+	EP_ASSERT(pathOfTextureHandle.count(texture));
+	EP_ASSERT(textureReferenceCount.count(pathOfTextureHandle[texture]));
+
+	textureReferenceCount[pathOfTextureHandle[texture]]++;
+}
+
 void Graphics::DeleteTexture(Graphics::TextureHandle texture)
 {
 	EP_ASSERT(texture);
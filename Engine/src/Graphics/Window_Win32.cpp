@@ -58,16 +58,22 @@ LRESULT CALLBACK Win32_WinProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lP
 		break;
 
 	case WM_CHAR: // Text entry
-		Events::Dispatch(HN("KeyChar"), char(wParam));
+	{
+		static const Events::EventSlot keyCharSlot = Events::GetEventSlot(HN("KeyChar"));
+		Events::Dispatch(keyCharSlot, char(wParam));
 		break;
-
+	}
 	case WM_MOUSEMOVE: // Mouse cursor position change
-		Events::Dispatch(HN("MousePosition"),
+	{
+		static const Events::EventSlot mousePositionSlot = Events::GetEventSlot(HN("MousePosition"));
+		Events::Dispatch(mousePositionSlot,
 			glm::vec2(GET_X_LPARAM(lParam), float(windowHeight) - GET_Y_LPARAM(lParam)));
 		break;
+	}
 
 	case WM_INPUT: // Raw Input API
 	{
+		static const Events::EventSlot rawInputSlot = Events::GetEventSlot(HN("Win32_RawInput"));
 		UINT RIDataSize = sizeof(RAWINPUT);
 		BYTE RIData[sizeof(RAWINPUT)];
 
@@ -75,7 +81,7 @@ LRESULT CALLBACK Win32_WinProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lP
 			GetRawInputData((HRAWINPUT)lParam, RID_INPUT, RIData, &RIDataSize, sizeof(RAWINPUTHEADER))
 			<= RIDataSize);
 
-		Events::Dispatch(HN("Win32_RawInput"), (RAWINPUT*)RIData);
+		Events::Dispatch(rawInputSlot, (RAWINPUT*)RIData);
 
 		return DefWindowProc(hWnd, message, wParam, lParam);
 		break;
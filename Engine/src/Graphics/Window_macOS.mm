@@ -47,15 +47,18 @@ static float aspectRatio;
 // Keyboard input
 - (void)keyDown:(NSEvent *)event
 {
-	Events::Dispatch(HN("macOS_keyEvent"), std::pair<unsigned short, bool>(event.keyCode, true));
+	static const Events::EventSlot keyEventSlot = Events::GetEventSlot(HN("macOS_keyEvent"));
+	Events::Dispatch(keyEventSlot, std::pair<unsigned short, bool>(event.keyCode, true));
 }
 - (void)keyUp:(NSEvent *)event
 {
-	Events::Dispatch(HN("macOS_keyEvent"), std::pair<unsigned short, bool>(event.keyCode, false));
+	static const Events::EventSlot keyEventSlot = Events::GetEventSlot(HN("macOS_keyEvent"));
+	Events::Dispatch(keyEventSlot, std::pair<unsigned short, bool>(event.keyCode, false));
 }
 - (void)flagsChanged:(NSEvent *)event
 {
-	Events::Dispatch(HN("macOS_flagsChanged"), (uint64_t)event.modifierFlags);
+	static const Events::EventSlot flagsChangedSlot = Events::GetEventSlot(HN("macOS_flagsChanged"));
+	Events::Dispatch(flagsChangedSlot, (uint64_t)event.modifierFlags);
 }
 
 @end
@@ -12,6 +12,8 @@ Input::KBMouseBuffer Input::kbmBuffer;
 glm::vec2 Input::cursorPos;
 std::vector<Input::GamePadBuffer> Input::gpBuffer; // Accessed by ControllerID - 2.
 bool Input::currentBuffer = 0;
+Input::TracedInputFrame Input::replayedInputFrame;
+bool Input::hasReplayedInputFrame = false;
 
 std::map<HashName, Input::Context> Input::contextRegistry;
 std::list<Input::Context> Input::contextStack[MaxInputContextLayers];
@@ -21,6 +23,9 @@ std::map<void*, std::map<HashName, float>> Input::axisValues[2]; // Array index
 static float mouseAxisAccumulator[4] = { 0 };
 static float mouseDeltaAccumulator = 0.0f;
 
+HN_CONSTANT(controllerWakeEvent, "ControllerWake");
+HN_CONSTANT(inputFrameEvent, "InputFrame");
+
 static std::vector<Input::ControllerID> StreamBindings; // Indexed by StreamID.
 static std::vector<bool> isStreamBlocked; // Indexed by StreamID.
 
@@ -653,7 +658,7 @@ void Input::CheckForControllerWake()
 		if (kbmBuffer.keys[currentBuffer][0] > kbmBuffer.keys[!currentBuffer][0] ||
 			kbmBuffer.keys[currentBuffer][1] > kbmBuffer.keys[!currentBuffer][1])
 		{
-			Events::Dispatch(HN("ControllerWake"), ControllerID(1));
+			Events::Dispatch(controllerWakeEvent, ControllerID(1));
 		}
 		// Check for axes changes.
 		else
@@ -671,7 +676,7 @@ void Input::CheckForControllerWake()
 			// Check for button presses
 			if (gpIt->buttons[currentBuffer] > gpIt->buttons[!currentBuffer])
 			{
-				Events::Dispatch(HN("ControllerWake"), ControllerID(gpIt - gpBuffer.begin() + 2));
+				Events::Dispatch(controllerWakeEvent, ControllerID(gpIt - gpBuffer.begin() + 2));
 			}
 			// Check for axes changes
 			else
@@ -682,7 +687,7 @@ void Input::CheckForControllerWake()
 				{
 					if (gpIt->axes[currentBuffer][i] != gpIt->axes[!currentBuffer][i])
 					{
-						Events::Dispatch(HN("ControllerWake"), ControllerID(gpIt - gpBuffer.begin() + 2));
+						Events::Dispatch(controllerWakeEvent, ControllerID(gpIt - gpBuffer.begin() + 2));
 						break;
 					}
 				}
@@ -983,10 +988,76 @@ void Input::ProcessContext(Input::Context& context)
 }
 
 
+void Input::TraceRawInput()
+{
+	TracedInputFrame frame;
+	std::memset(&frame, 0, sizeof(frame)); // Padding is written to the trace as well
+
+	std::memcpy(frame.keys, kbmBuffer.keys[currentBuffer], sizeof(frame.keys));
+	std::memcpy(frame.mouseAxes, kbmBuffer.axes[currentBuffer], sizeof(frame.mouseAxes));
+	frame.gamepadCount = uint32_t(std::min(gpBuffer.size(), MaxTracedGamepads));
+	for (size_t i = 0; i < frame.gamepadCount; i++)
+	{
+		frame.gamepadButtons[i] = gpBuffer[i].buttons[currentBuffer];
+		std::memcpy(frame.gamepadAxes[i], gpBuffer[i].axes[currentBuffer], sizeof(frame.gamepadAxes[i]));
+	}
+
+	Events::tracePolledState(inputFrameEvent, frame);
+}
+
+void Input::ApplyReplayedRawInput()
+{
+	// Live platform input is blocked during replays, so the buffers only change here
+	if (!hasReplayedInputFrame)
+	{
+		EP_WARN("Input: The event trace has no raw input for frame {}.  Input from the previous frame will be held.",
+			Time::FrameCount());
+		return;
+	}
+	hasReplayedInputFrame = false;
+
+	std::memcpy(kbmBuffer.keys[currentBuffer], replayedInputFrame.keys, sizeof(replayedInputFrame.keys));
+	std::memcpy(kbmBuffer.axes[currentBuffer], replayedInputFrame.mouseAxes, sizeof(replayedInputFrame.mouseAxes));
+	if (gpBuffer.size() < replayedInputFrame.gamepadCount)
+	{
+		gpBuffer.resize(replayedInputFrame.gamepadCount);
+	}
+	for (size_t i = 0; i < gpBuffer.size(); i++)
+	{
+		if (i < replayedInputFrame.gamepadCount)
+		{
+			gpBuffer[i].buttons[currentBuffer] = replayedInputFrame.gamepadButtons[i];
+			std::memcpy(gpBuffer[i].axes[currentBuffer], replayedInputFrame.gamepadAxes[i],
+				sizeof(replayedInputFrame.gamepadAxes[i]));
+		}
+		else
+		{
+			gpBuffer[i].buttons[currentBuffer] = 0;
+			std::memset(gpBuffer[i].axes[currentBuffer], 0, sizeof(gpBuffer[i].axes[currentBuffer]));
+		}
+	}
+}
+
+
 void Input::Init()
 {
 	PlatformInit();
 
+	// Allow window and text input events to be replayed from event traces
+	Events::RegisterTraceType<glm::vec2>();
+	Events::RegisterTraceType<char>();
+
+	// Raw input is traced once per frame.  Replays apply the recorded state instead of polling.
+	Events::RegisterTraceType<TracedInputFrame>();
+	Events::Subscribe(
+		inputFrameEvent,
+		[](Events::Event& e)
+		{
+			replayedInputFrame = Events::Unpack<TracedInputFrame>(e);
+			hasReplayedInputFrame = true;
+			return true;
+		});
+
 	// Clear event-based input buffers if the window loses focus.
 	Events::Subscribe(
 		HN("WindowLostFocus"),
@@ -1014,6 +1085,17 @@ void Input::Init()
 
 void Input::Update()
 {
+	// Poll raw input, or take it from the trace being replayed
+	if (Events::IsReplayingTrace())
+	{
+		ApplyReplayedRawInput();
+	}
+	else
+	{
+		GetRawInput();
+		TraceRawInput();
+	}
+
 	// Clear raw input block flags
 	std::fill(isStreamBlocked.begin(), isStreamBlocked.end(), false);
 	kbmBuffer.keys_blockstatus[0] = 0;
@@ -1049,7 +1131,6 @@ void Input::Update()
 	}
 
 	// Process input
-	GetRawInput();
 	CheckForControllerWake();
 	for (int i = 0; i < MaxInputContextLayers; i++)
 	{
@@ -6,6 +6,8 @@
 
 using Enterprise::Events;
 
+HN_CONSTANT(rawInputEvent, "Win32_RawInput");
+
 static bool xinputWasConnected[4] = { 0 };
 static DWORD xinputPrevPacketNo[4] = { 0 };
 static bool xinputAlreadyCopiedBuffer[4] = { 0 };
@@ -32,12 +34,15 @@ void Enterprise::Input::PlatformInit()
 
 	EP_VERIFY_NEQ(RegisterRawInputDevices(device, 2, sizeof(device[0])), FALSE);
 
-	Events::Subscribe(HN("Win32_RawInput"), &HandlePlatformEvents);
+	Events::Subscribe(rawInputEvent, &HandlePlatformEvents);
+
+	// Raw input payloads are pointers, so their effects are traced through Input::TraceRawInput() instead
+	Events::excludeFromTrace(rawInputEvent);
 }
 
 bool Enterprise::Input::HandlePlatformEvents(Events::Event& e)
 {
-	EP_ASSERT_SLOW(e.Type() == HN("Win32_RawInput"));
+	EP_ASSERT_SLOW(e.Type() == rawInputEvent);
 
 	RAWINPUT* ridata = Events::Unpack<RAWINPUT*>(e);
 	ControlID control = ControlID::_EndOfIDs;
@@ -109,6 +109,10 @@ void Input::PlatformInit()
 	// Subscribe to keyboard events
 	Events::Subscribe(HN("macOS_keyEvent"), &HandlePlatformEvents);
 	Events::Subscribe(HN("macOS_flagsChanged"), &HandlePlatformEvents);
+
+	// Their effects are traced through Input::TraceRawInput() instead
+	Events::excludeFromTrace(HN("macOS_keyEvent"));
+	Events::excludeFromTrace(HN("macOS_flagsChanged"));
 }
 
 bool Input::HandlePlatformEvents(Events::Event& e)
@@ -155,10 +155,19 @@ Runtime::Runtime()
 
 	#ifdef EP_CONFIG_DEBUG
 	Console::Init();
+	HN_CheckStaticRegistry();
 	#endif
 
 	RegisterCmdLineOption("Help", { "-h", "--help" }, 
 						  "Displays command line options supported by this game.", 0);
+	RegisterCmdLineOption("Record Event Trace", { "--record-trace" },
+						  "Records every dispatched event to the specified trace file.", 1);
+	RegisterCmdLineOption("Replay Event Trace", { "--replay-trace" },
+						  "Replays the specified event trace file, then quits.", 1);
+#ifdef EP_CONFIG_DEBUG
+	RegisterCmdLineOption("HashName Table", { "--hashname-table" },
+						  "Saves every hashed string to the specified file on exit.", 1);
+#endif
 
 	Events::Subscribe(HN("QuitRequested"), OnQuitRequested);
 
@@ -169,6 +178,19 @@ Runtime::Runtime()
 #endif // EP_BUILD_DYNAMIC
 
 	File::Init();
+
+	// Event traces use virtual paths, so they start once the file system is ready
+	if (CheckCmdLineOption(HN("--record-trace")))
+	{
+		std::vector<std::string> traceArgs = GetCmdLineOption(HN("--record-trace"));
+		if (!traceArgs.empty()) Events::StartTraceRecording(traceArgs.front());
+	}
+	if (CheckCmdLineOption(HN("--replay-trace")))
+	{
+		std::vector<std::string> traceArgs = GetCmdLineOption(HN("--replay-trace"));
+		if (!traceArgs.empty()) Events::StartTraceReplay(traceArgs.front(), true);
+	}
+
 	Input::Init();
 	Graphics::Init();
 	Time::Init();
@@ -192,6 +214,7 @@ Runtime::Runtime()
 
 bool Runtime::Run()
 {
+	Events::BeginTraceFrame();
 	Time::Update();
 	Input::Update();
 
@@ -208,6 +231,8 @@ bool Runtime::Run()
 		SceneManager::FixedUpdate();
 		StateManager::FixedUpdate();
 #endif
+		SceneManager::ApplyCommandBuffers();
+		Events::DeliverPosted(Events::SyncPoint::AfterFixedUpdate);
 	}
 
 	// Update
@@ -221,6 +246,8 @@ bool Runtime::Run()
 	SceneManager::Update();
 	StateManager::Update();
 #endif
+	SceneManager::ApplyCommandBuffers();
+	Events::DeliverPosted(Events::SyncPoint::AfterUpdate);
 
 	// Draw
 #ifdef EP_BUILD_DYNAMIC
@@ -231,6 +258,8 @@ bool Runtime::Run()
 
 	Graphics::PreDraw();
 	SceneManager::PreDraw();
+	SceneManager::ApplyCommandBuffers();
+	Events::DeliverPosted(Events::SyncPoint::BeforeDraw);
 
 #ifdef EP_BUILD_DYNAMIC
 	if (isRunning) StateManager::Draw();
@@ -238,6 +267,7 @@ bool Runtime::Run()
 	StateManager::Draw();
 #endif // EP_BUILD_DYNAMIC
 
+	Events::EndTraceFrame();
 	return isRunning;
 }
 
@@ -248,8 +278,16 @@ Runtime::~Runtime()
 	::GameSysCleanup();
 #endif // EP_BUILD_DYNAMIC
 
+	Events::StopTraceRecording();
+#ifdef EP_CONFIG_DEBUG
+	if (CheckCmdLineOption(HN("--hashname-table")))
+	{
+		std::vector<std::string> tableArgs = GetCmdLineOption(HN("--hashname-table"));
+		if (!tableArgs.empty()) HN_SaveTable(File::VirtualPathToNative(tableArgs.front()));
+	}
+#endif
 	StateManager::Cleanup();
-	//SceneManager::Cleanup();
+	SceneManager::Cleanup();
 
 	Time::Cleanup();
 	Graphics::Cleanup();
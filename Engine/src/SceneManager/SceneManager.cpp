@@ -1,14 +1,50 @@
+#include <array>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <chrono>
+#include <cmath>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
 #include "Enterprise/SceneManager.h"
 #include "Enterprise/File.h"
 #include "Enterprise/Events.h"
+#include "Enterprise/Runtime.h"
+#include "Enterprise/Time.h"
+#include "Enterprise/SceneManager/SceneFileFormat.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+	#include <emmintrin.h>
+	#define EP_SCENE_SIMD_SSE2
+#elif defined(_M_ARM64) || (defined(__aarch64__) && defined(__ARM_NEON))
+	#include <arm_neon.h>
+	#define EP_SCENE_SIMD_NEON
+#endif
 
 namespace Enterprise
 {
 
+HN_CONSTANT(entitiesDeletedEvent, "EntitiesDeleted");
+
 static std::vector<SceneManager::DelComponentFn> dcfs;
+static std::vector<SceneManager::BatchDelComponentFn> bdcfs; // Parallel to dcfs.  nullptr if not registered.
+static std::map<HashName, size_t> dcfIndices;
 static std::map<HashName, SceneManager::QueryComponentFn> qcfs;
+static std::unordered_map<HashName, SceneManager::HasComponentFn> hcfs;
 static std::vector<std::pair<HashName, SceneManager::TextSerializeFn>> tsfs;
 static std::map<HashName, SceneManager::TextDeserializeFn> tdfs;
+static std::unordered_map<HashName, SceneManager::BinarySerializeFn> bsfs;
+static std::unordered_map<HashName, SceneManager::BinaryDeserializeFn> bdfs;
+
+struct SnapshotFns
+{
+	HashName type;
+	SceneManager::SaveSnapshotFn save;
+	SceneManager::RestoreSnapshotFn restore;
+	SceneManager::ReleaseSnapshotFn release;
+};
+static std::vector<SnapshotFns> snapshotFns;
 
 void SceneManager::RegisterComponentType(HashName name,
 	DelComponentFn dcf, QueryComponentFn qcf,
@@ -20,604 +56,3591 @@ void SceneManager::RegisterComponentType(HashName name,
 	EP_ASSERT(tsf);
 	EP_ASSERT(tdf);
 
+	dcfIndices[name] = dcfs.size();
 	dcfs.push_back(dcf);
+	bdcfs.push_back(nullptr);
 	qcfs[name] = qcf;
 	tsfs.emplace_back(std::pair(name, tsf));
 	tdfs[name] = tdf;
 }
 
+void SceneManager::RegisterSnapshotFns(HashName name,
+	SaveSnapshotFn ssf, RestoreSnapshotFn rsf, ReleaseSnapshotFn relsf)
+{
+	EP_ASSERTF(dcfIndices.count(name) != 0, "SceneManager: Component type must be registered before its snapshot "
+		"callbacks!");
+	EP_ASSERT(ssf);
+	EP_ASSERT(rsf);
+	EP_ASSERTF(std::none_of(snapshotFns.begin(), snapshotFns.end(),
+		[name](const SnapshotFns& fns) { return fns.type == name; }),
+		"SceneManager: Snapshot callbacks registered twice for the same type!");
+
+	snapshotFns.push_back({ name, ssf, rsf, relsf });
+}
 
-struct Entity
+void SceneManager::RegisterBatchDeleter(HashName name, BatchDelComponentFn bdcf)
 {
-	EntityID id = 0;
-	HashName name = HN_NULL;
-	//EntityID parent;
-	//std::set<EntityID> children;
-	//std::set<HashName> tags;
-	glm::vec3 position;
-	glm::quat rotation;
-	glm::vec3 scale;
-};
-static std::vector<Entity> entityPool(Constants::MaxEntities);
+	EP_ASSERTF(dcfIndices.count(name) != 0, "SceneManager: Component type must be registered before its batch "
+		"deleter!");
+	EP_ASSERT(bdcf);
 
-static std::map<EntityID, size_t> entityIndices;
-static std::vector<size_t> availableEntityPoolIndices(Constants::MaxEntities);
-static std::vector<EntityID> availableSpawnedIDs(Constants::MaxSpawnedEntities);
+	bdcfs[dcfIndices[name]] = bdcf;
+}
 
-static EntityID genSpawnedEntityID()
-	// Helper function: returns a unique EntityID in range [1, Constants::MaxSpawnedIDs].
+void SceneManager::RegisterComponentCheck(HashName name, HasComponentFn hcf)
 {
-	EntityID returnVal = availableSpawnedIDs.back();
-	availableSpawnedIDs.pop_back();
-	return returnVal;
+	EP_ASSERTF(qcfs.count(name) != 0, "SceneManager: Component type must be registered before its component check!");
+	EP_ASSERT(hcfs.count(name) == 0);
+	EP_ASSERT(hcf);
+
+	hcfs[name] = hcf;
 }
 
-EntityID SceneManager::CreateEntity(HashName name, glm::vec3 position, glm::quat rotation, glm::vec3 scale)
+static bool entityHasComponent(HashName componentType, EntityID entity)
+	// Helper function: checks whether an entity has a component type attached.  The type must be registered.
 {
-	EntityID id = genSpawnedEntityID();
-	entityPool[availableEntityPoolIndices.back()] = { id, name, position, rotation, scale };
-	entityIndices[id] = availableEntityPoolIndices.back();
-	availableEntityPoolIndices.pop_back();
-	return id;
+	auto hcfIt = hcfs.find(componentType);
+	if (hcfIt != hcfs.end())
+	{
+		return hcfIt->second(entity);
+	}
+
+	std::vector<EntityID> entities = qcfs[componentType]();
+	return std::find(entities.begin(), entities.end(), entity) != entities.end();
 }
 
-void SceneManager::DeleteEntity(EntityID entity)
+void SceneManager::RegisterBinarySerializers(HashName name, BinarySerializeFn bsf, BinaryDeserializeFn bdf)
+{
+	EP_ASSERTF(tdfs.count(name) != 0, "SceneManager: Component type must be registered before its binary serializers!");
+	EP_ASSERT(bsfs.count(name) == 0);
+	EP_ASSERT(bsf);
+	EP_ASSERT(bdf);
+
+	bsfs[name] = bsf;
+	bdfs[name] = bdf;
+}
+
+
+
+static std::unordered_map<std::type_index, SparseSetBase*> componentPools;
+
+// Change ticks.  Every change is stamped with changeTick, which advances whenever a tick is captured, so changes made
+// after a capture always compare greater than the captured tick.
+static uint32_t changeTick = 1;
+static std::array<uint32_t, Constants::ChangeHistoryFrames> frameStartTicks = {}; // Ring buffer
+static size_t frameCount = 0;
+
+uint32_t CurrentChangeTick()
+{
+	return changeTick;
+}
+
+uint32_t SceneManager::CaptureChangeTick()
+{
+	return changeTick++;
+}
+
+uint32_t SceneManager::GetOldestTrackedTick()
+{
+	return frameCount < Constants::ChangeHistoryFrames ? 0 : frameStartTicks[frameCount % Constants::ChangeHistoryFrames];
+}
+
+void SceneManager::registerComponentPool(std::type_index type, SparseSetBase* pool)
+{
+	EP_ASSERT(pool);
+	EP_ASSERTF(componentPools.count(type) == 0, "SceneManager: Component pool registered twice for the same type!");
+
+	componentPools[type] = pool;
+}
+
+SparseSetBase* SceneManager::getComponentPool(std::type_index type)
+{
+	auto it = componentPools.find(type);
+	return it != componentPools.end() ? it->second : nullptr;
+}
+
+
+// Entity names live in the sparse set.  Transforms are kept in separate arrays parallel to its dense array.
+static SparseSet<HashName> entityPool;
+static ChunkedArray<glm::vec3> entityPositions;
+static ChunkedArray<glm::quat> entityRotations;
+static ChunkedArray<glm::vec3> entityScales;
+
+// Local transforms as of the start of the current fixed timestep, for interpolation.  Parallel to the entity pool's
+// dense array.
+static ChunkedArray<glm::vec3> entityPrevPositions;
+static ChunkedArray<glm::quat> entityPrevRotations;
+static bool inFixedUpdate = false;
+//static std::vector<std::set<HashName>> entityTags;
+
+// Hierarchy links, also parallel to the dense array.  The children of an entity form a doubly linked list.
+static ChunkedArray<EntityID> entityParents;
+static ChunkedArray<EntityID> entityFirstChildren;
+static ChunkedArray<EntityID> entityNextSiblings;
+static ChunkedArray<EntityID> entityPrevSiblings;
+static ChunkedArray<size_t> entityWorldSlots; // Position of each entity in the world transform cache
+
+// World transform cache.  Entities are laid out in hierarchy preorder, so every parent precedes its children and
+// each subtree occupies a contiguous range of slots ending at worldSubtreeEnds[slot].
+constexpr size_t NoParentSlot = SIZE_MAX;
+static std::vector<size_t> worldDenseIndices;
+static std::vector<size_t> worldParentSlots;
+static std::vector<size_t> worldSubtreeEnds;
+static std::vector<uint8_t> worldDirtyFlags;
+static std::vector<glm::mat4> worldMatrices;
+// Interpolated world matrices for rendering, parallel to worldMatrices.  Every slot changes whenever the
+// interpolation fraction does, so they are recalculated all at once, at most once per fraction or transform change.
+static std::vector<glm::mat4> worldInterpMatrices;
+static float worldInterpFraction = -1.0f;
+static std::atomic<bool> worldInterpDirty = true;
+// The flags are atomic, and updates are serialized by worldTransformMutex, so that systems reading world transforms
+// in parallel can bring the cache up to date safely.
+static std::atomic<bool> worldOrderDirty = false; // The hierarchy changed shape, so the cache must be laid out again
+static std::atomic<bool> worldMatricesDirty = false; // At least one slot is flagged dirty
+static std::mutex worldTransformMutex;
+
+static inline void markWorldDirty(size_t index)
+	// Helper function: flags an entity's world transform, and those of its descendants, for recalculation.
 {
-	if (entityIndices.count(entity) != 0)
+	if (!worldOrderDirty)
 	{
-		// Delete any attached components
-		for (const DelComponentFn& dcf : dcfs)
-		{
-			dcf(entity);
-		}
+		worldDirtyFlags[entityWorldSlots[index]] = 1;
+		worldMatricesDirty = true;
+	}
+}
 
-		// Mark entity as deleted
-		if (entity <= Constants::MaxSpawnedEntities)
-		{
-			availableSpawnedIDs.push_back(entity);
-		}
-		availableEntityPoolIndices.push_back(entityIndices[entity]);
-		entityIndices.erase(entity);
+// Spatial grid.  Entity origins, in world space, are bucketed into the cubic cells of a sparse hash grid.  Entities
+// are moved between cells as their world transforms are recalculated, so only moving entities cost anything to index.
+struct SpatialEntry
+{
+	EntityID entity;
+	glm::vec3 position;
+};
+struct GridLocation
+{
+	uint64_t key;
+	size_t slot; // Position within the cell
+	std::vector<SpatialEntry>* cell; // Map nodes never move, so this stays valid while the cell is occupied
+};
+constexpr uint64_t NoGridCell = UINT64_MAX;
+constexpr int64_t GridCoordLimit = (1 << 20) - 1; // Cell coordinates are packed into 21 bits each
+static float gridCellSize = Constants::DefaultSpatialCellSize;
+static std::unordered_map<uint64_t, std::vector<SpatialEntry>> gridCells;
+static ChunkedArray<GridLocation> entityGridLocations; // Parallel to the entity pool's dense array
+
+static inline int64_t gridCoordOf(float value)
+	// Helper function: gets the cell coordinate containing a world coordinate.
+{
+	float cell = std::floor(value / gridCellSize);
+	if (!(cell > -float(GridCoordLimit))) // Also catches NaN
+		return -GridCoordLimit;
+	if (cell > float(GridCoordLimit))
+		return GridCoordLimit;
+	return int64_t(cell);
+}
+
+static inline uint64_t gridKeyOf(int64_t x, int64_t y, int64_t z)
+{
+	return (uint64_t(x + GridCoordLimit) << 42) | (uint64_t(y + GridCoordLimit) << 21) | uint64_t(z + GridCoordLimit);
+}
 
-		Events::Dispatch(HN("EntityDeleted"), entity);
+static void removeFromGrid(size_t index)
+	// Helper function: removes an entity from its grid cell, if it is in one.
+{
+	GridLocation& location = entityGridLocations[index];
+	if (location.key == NoGridCell)
+		return;
+
+	std::vector<SpatialEntry>& cell = *location.cell;
+	if (location.slot != cell.size() - 1)
+	{
+		cell[location.slot] = cell.back();
+		entityGridLocations[entityPool.IndexOf(cell[location.slot].entity)].slot = location.slot;
 	}
-	else
+	cell.pop_back();
+	if (cell.empty())
 	{
-		EP_WARN("SceneManager::DeleteEntity(): EntityID {} does not exist!", entity);
+		gridCells.erase(location.key);
 	}
+
+	location = { NoGridCell, 0, nullptr };
 }
 
-void SceneManager::PurgeSpawnedEntities()
+static void updateGridEntry(size_t index, glm::vec3 position)
+	// Helper function: records an entity's new world position, moving it to another cell if needed.
 {
-	while (entityIndices.size() > 0)
+	uint64_t key = gridKeyOf(gridCoordOf(position.x), gridCoordOf(position.y), gridCoordOf(position.z));
+	GridLocation& location = entityGridLocations[index];
+	if (location.key == key)
 	{
-		EntityID id = entityIndices.begin()->first;
-		if (id > Constants::MaxSpawnedEntities)
-			return;
+		(*location.cell)[location.slot].position = position;
+		return;
+	}
 
-		// Delete any attached components
-		for (const DelComponentFn& dcf : dcfs)
-		{
-			dcf(id);
-		}
+	removeFromGrid(index);
+	std::vector<SpatialEntry>& cell = gridCells[key];
+	location = { key, cell.size(), &cell };
+	cell.push_back({ entityPool.EntityAt(index), position });
+}
 
-		// Mark entity as deleted
-		availableSpawnedIDs.push_back(id);
-		availableEntityPoolIndices.push_back(entityIndices.begin()->second);
-		entityIndices.erase(entityIndices.begin());
+static inline void transformChanged(size_t index)
+	// Helper function: records a write to an entity's local transform.
+{
+	entityPool.MarkChangedAt(index);
+	markWorldDirty(index);
 
-		Events::Dispatch(HN("EntityDeleted"), id);
+	// Writes outside of FixedUpdate() are teleports, and are not interpolated
+	if (!inFixedUpdate)
+	{
+		entityPrevPositions[index] = entityPositions[index];
+		entityPrevRotations[index] = entityRotations[index];
 	}
 }
 
-
-bool SceneManager::IsEntityValid(EntityID entity)
+static void capturePreviousTransforms()
+	// Helper function: copies every local position and rotation into the interpolation buffers.
 {
-	return entityIndices.count(entity);
+	for (size_t chunk = 0; chunk < entityPositions.ChunkCount(); chunk++)
+	{
+		size_t length = entityPositions.ChunkLength(chunk);
+		std::memcpy(entityPrevPositions.ChunkData(chunk), entityPositions.ChunkData(chunk), length * sizeof(glm::vec3));
+		std::memcpy(entityPrevRotations.ChunkData(chunk), entityRotations.ChunkData(chunk), length * sizeof(glm::quat));
+	}
+	// Every interpolation input changed, even if no transform was written
+	worldInterpDirty = true;
 }
 
-
-glm::vec3 SceneManager::GetEntityPosition(EntityID entity)
+static void addEntity(EntityID entity, HashName name, glm::vec3 position, glm::quat rotation, glm::vec3 scale)
+	// Helper function: adds an entity to the pool and all parallel arrays.
 {
-	if (entityIndices.count(entity) != 0)
+	entityPool.Insert(entity, name);
+	entityPositions.PushBack(position);
+	entityRotations.PushBack(rotation);
+	entityScales.PushBack(scale);
+	entityPrevPositions.PushBack(position);
+	entityPrevRotations.PushBack(rotation);
+	entityParents.PushBack(0);
+	entityFirstChildren.PushBack(0);
+	entityNextSiblings.PushBack(0);
+	entityPrevSiblings.PushBack(0);
+	entityGridLocations.PushBack({ NoGridCell, 0, nullptr }); // Added to the grid with its first world transform
+
+	if (worldOrderDirty)
 	{
-		return entityPool.at(entityIndices[entity]).position;
+		entityWorldSlots.PushBack(0); // Assigned when the cache is laid out again
 	}
 	else
+		// New entities are roots, which can be appended to a preorder layout
 	{
-		EP_ERROR("SceneManager::GetEntityPosition(): EntityID {} does not exist!", entity);
-		return glm::vec3();
+		entityWorldSlots.PushBack(worldDenseIndices.size());
+		worldDenseIndices.push_back(entityPool.Size() - 1);
+		worldParentSlots.push_back(NoParentSlot);
+		worldSubtreeEnds.push_back(worldDenseIndices.size());
+		worldDirtyFlags.push_back(1);
+		worldMatrices.emplace_back(1.0f);
+		worldInterpMatrices.emplace_back(1.0f);
+		worldMatricesDirty = true;
 	}
 }
 
-glm::quat SceneManager::GetEntityRotation(EntityID entity)
+static void unlinkEntity(size_t index)
+	// Helper function: detaches an entity from its parent, making it a root.
 {
-	if (entityIndices.count(entity) != 0)
+	EntityID parent = entityParents[index];
+	if (parent == 0)
+		return;
+
+	EntityID prev = entityPrevSiblings[index];
+	EntityID next = entityNextSiblings[index];
+	if (prev)
 	{
-		return entityPool.at(entityIndices[entity]).rotation;
+		entityNextSiblings[entityPool.IndexOf(prev)] = next;
 	}
 	else
 	{
-		EP_ERROR("SceneManager::GetEntityRotation(): EntityID {} does not exist!", entity);
-		return glm::quat();
+		entityFirstChildren[entityPool.IndexOf(parent)] = next;
 	}
+	if (next)
+	{
+		entityPrevSiblings[entityPool.IndexOf(next)] = prev;
+	}
+
+	entityParents[index] = 0;
+	entityPrevSiblings[index] = 0;
+	entityNextSiblings[index] = 0;
+	worldOrderDirty = true;
 }
 
-glm::vec3 SceneManager::GetEntityScale(EntityID entity)
+static void linkEntity(size_t index, EntityID parent)
+	// Helper function: attaches a root entity to a parent as its first child.
 {
-	if (entityIndices.count(entity) != 0)
+	EP_ASSERT_SLOW(entityParents[index] == 0);
+
+	size_t parentIndex = entityPool.IndexOf(parent);
+	EntityID entity = entityPool.EntityAt(index);
+	EntityID oldFirstChild = entityFirstChildren[parentIndex];
+
+	entityParents[index] = parent;
+	entityPrevSiblings[index] = 0;
+	entityNextSiblings[index] = oldFirstChild;
+	if (oldFirstChild)
 	{
-		return entityPool.at(entityIndices[entity]).scale;
+		entityPrevSiblings[entityPool.IndexOf(oldFirstChild)] = entity;
 	}
-	else
+	entityFirstChildren[parentIndex] = entity;
+	worldOrderDirty = true;
+}
+
+static void moveEntityData(size_t from, size_t to)
+	// Helper function: mirrors a move within the entity pool's dense array in all parallel arrays.
+{
+	entityPositions[to] = entityPositions[from];
+	entityRotations[to] = entityRotations[from];
+	entityScales[to] = entityScales[from];
+	entityPrevPositions[to] = entityPrevPositions[from];
+	entityPrevRotations[to] = entityPrevRotations[from];
+	entityParents[to] = entityParents[from];
+	entityFirstChildren[to] = entityFirstChildren[from];
+	entityNextSiblings[to] = entityNextSiblings[from];
+	entityPrevSiblings[to] = entityPrevSiblings[from];
+	entityWorldSlots[to] = entityWorldSlots[from];
+	entityGridLocations[to] = entityGridLocations[from];
+}
+
+static void removeEntities(const EntityID* entities, size_t count)
+	// Helper function: removes entities from the pool and all parallel arrays.  Any children of the entities must be
+	// part of the same batch.
+{
+	for (size_t i = 0; i < count; i++)
 	{
-		EP_ERROR("SceneManager::GetEntityScale(): EntityID {} does not exist!", entity);
-		return glm::vec3();
+		unlinkEntity(entityPool.IndexOf(entities[i]));
+		removeFromGrid(entityPool.IndexOf(entities[i]));
+	}
+
+	entityPool.EraseBatch(entities, count, moveEntityData);
+	while (entityPositions.Size() > entityPool.Size())
+	{
+		entityPositions.PopBack();
+		entityRotations.PopBack();
+		entityScales.PopBack();
+		entityPrevPositions.PopBack();
+		entityPrevRotations.PopBack();
+		entityParents.PopBack();
+		entityFirstChildren.PopBack();
+		entityNextSiblings.PopBack();
+		entityPrevSiblings.PopBack();
+		entityWorldSlots.PopBack();
+		entityGridLocations.PopBack();
 	}
+
+	// Dense indices in the cache are now stale
+	worldOrderDirty = true;
 }
 
+static size_t spawnedIDRange = Constants::DefaultSpawnedIDRange;
+static uint32_t nextUnusedSpawnedIndex = 1;
+static std::vector<uint32_t> availableSpawnedIndices;
+static ChunkedArray<uint32_t> spawnedGenerations; // Position i holds the generation of slot index i + 1
 
-std::vector<EntityID> SceneManager::GetEntitiesWithComponent(HashName componentType)
+static inline bool isSpawnedID(EntityID entity)
+	// Helper function: checks whether an EntityID falls in the spawned range rather than the scene file range.
 {
-	if (qcfs.count(componentType) != 0)
+	return EntityID_Index(entity) <= spawnedIDRange;
+}
+
+static EntityID genSpawnedEntityID()
+	// Helper function: returns a unique EntityID with a slot index in range [1, spawnedIDRange], or 0 if the range
+	// is exhausted.
+{
+	uint32_t index;
+	if (!availableSpawnedIndices.empty())
 	{
-		return qcfs[componentType]();
+		index = availableSpawnedIndices.back();
+		availableSpawnedIndices.pop_back();
+	}
+	else if (nextUnusedSpawnedIndex <= spawnedIDRange)
+	{
+		index = nextUnusedSpawnedIndex++;
+		spawnedGenerations.PushBack(0);
 	}
 	else
 	{
-		EP_ERROR("SceneManager::GetEntitiesWithComponent(): \"{}\" is not a valid component type.  "
-			"Did you register the required system using SceneManager::RegisterComponentType()?",
-			HN_ToStr(componentType));
-		return {};
+		return 0;
 	}
+
+	return EntityID_Make(index, spawnedGenerations[index - 1]);
 }
 
+static inline uint32_t nextSpawnedGeneration(uint32_t generation)
+	// Helper function: gets the generation that follows another.  PendingGeneration is reserved by command buffers.
+{
+	generation++;
+	return generation == EntityCommandBuffer::PendingGeneration ? 0 : generation;
+}
 
-void SceneManager::SaveEntitiesToTextFile(std::string path, const std::vector<EntityID>& entities)
+static void releaseSpawnedEntityID(EntityID entity)
+	// Helper function: returns a spawned slot to the free list, invalidating all outstanding copies of its ID.
 {
-	YAML::Emitter outYaml;
-	outYaml << YAML::BeginMap; // File-wide
+	uint32_t index = EntityID_Index(entity);
+	spawnedGenerations[index - 1] = nextSpawnedGeneration(spawnedGenerations[index - 1]);
+	availableSpawnedIndices.push_back(index);
+}
 
-	// Entities
-	outYaml << YAML::Key << "Entities" << YAML::Value << YAML::BeginMap;
-	if (entities.size() == 0)
+EntityID SceneManager::CreateEntity(HashName name, glm::vec3 position, glm::quat rotation, glm::vec3 scale)
+{
+	EntityID id = genSpawnedEntityID();
+	if (id == 0)
 	{
-		for (const auto& [id, index] : entityIndices)
-		{
-			outYaml << YAML::Key << id << YAML::Value << YAML::BeginMap;
-			outYaml << YAML::Key << "Name" << YAML::Value << HN_ToStr(entityPool.at(index).name);
-			outYaml << YAML::Key << "Position" << YAML::Value << YAML::BeginMap;
-			outYaml << YAML::Key << "x" << YAML::Value << entityPool.at(index).position.x;
-			outYaml << YAML::Key << "y" << YAML::Value << entityPool.at(index).position.y;
-			outYaml << YAML::Key << "z" << YAML::Value << entityPool.at(index).position.z;
-			outYaml << YAML::EndMap;
-			outYaml << YAML::Key << "Rotation" << YAML::Value << YAML::BeginMap;
-			outYaml << YAML::Key << "w" << YAML::Value << entityPool.at(index).rotation.w;
-			outYaml << YAML::Key << "x" << YAML::Value << entityPool.at(index).rotation.x;
-			outYaml << YAML::Key << "y" << YAML::Value << entityPool.at(index).rotation.y;
-			outYaml << YAML::Key << "z" << YAML::Value << entityPool.at(index).rotation.z;
-			outYaml << YAML::EndMap;
-			outYaml << YAML::Key << "Scale" << YAML::Value << YAML::BeginMap;
-			outYaml << YAML::Key << "x" << YAML::Value << entityPool.at(index).scale.x;
-			outYaml << YAML::Key << "y" << YAML::Value << entityPool.at(index).scale.y;
-			outYaml << YAML::Key << "z" << YAML::Value << entityPool.at(index).scale.z;
-			outYaml << YAML::EndMap;
-			outYaml << YAML::EndMap;
-		}
+		EP_ERROR("SceneManager::CreateEntity(): All {} spawned EntityIDs are in use!  Raise \"SpawnedIDRange\" in "
+			"the project file.", spawnedIDRange);
+		return 0;
 	}
-	else
+
+	addEntity(id, name, position, rotation, scale);
+	return id;
+}
+
+size_t SceneManager::GetSpawnedIDRange()
+{
+	return spawnedIDRange;
+}
+
+void SceneManager::DeleteEntities(const EntityID* entities, size_t count)
+{
+	EP_ASSERT(entities || count == 0);
+
+	// Gather the entities and all of their descendants.  Batches of several entities may overlap, so IDs are
+	// deduplicated.
+	std::vector<EntityID> batch;
+	std::unordered_set<EntityID> gathered;
+	std::vector<EntityID> stack;
+	for (size_t i = 0; i < count; i++)
 	{
-		for (EntityID id : entities)
+		if (!entityPool.Contains(entities[i]))
 		{
-			if (entityIndices.count(id) != 0)
-			{
-				outYaml << YAML::Key << id << YAML::Value << YAML::BeginMap;
-				outYaml << YAML::Key << "Name" << YAML::Value << HN_ToStr(entityPool.at(entityIndices[id]).name);
-				outYaml << YAML::Key << "Position" << YAML::Value << YAML::BeginMap;
-				outYaml << YAML::Key << "x" << YAML::Value << entityPool.at(entityIndices[id]).position.x;
-				outYaml << YAML::Key << "y" << YAML::Value << entityPool.at(entityIndices[id]).position.y;
-				outYaml << YAML::Key << "z" << YAML::Value << entityPool.at(entityIndices[id]).position.z;
-				outYaml << YAML::EndMap;
-				outYaml << YAML::Key << "Rotation" << YAML::Value << YAML::BeginMap;
-				outYaml << YAML::Key << "w" << YAML::Value << entityPool.at(entityIndices[id]).rotation.w;
-				outYaml << YAML::Key << "x" << YAML::Value << entityPool.at(entityIndices[id]).rotation.x;
-				outYaml << YAML::Key << "y" << YAML::Value << entityPool.at(entityIndices[id]).rotation.y;
-				outYaml << YAML::Key << "z" << YAML::Value << entityPool.at(entityIndices[id]).rotation.z;
-				outYaml << YAML::EndMap;
-				outYaml << YAML::Key << "Scale" << YAML::Value << YAML::BeginMap;
-				outYaml << YAML::Key << "x" << YAML::Value << entityPool.at(entityIndices[id]).scale.x;
-				outYaml << YAML::Key << "y" << YAML::Value << entityPool.at(entityIndices[id]).scale.y;
-				outYaml << YAML::Key << "z" << YAML::Value << entityPool.at(entityIndices[id]).scale.z;
-				outYaml << YAML::EndMap;
-				outYaml << YAML::EndMap;
-			}
-			else
+			EP_WARN("SceneManager::DeleteEntities(): EntityID {} does not exist!", entities[i]);
+			continue;
+		}
+
+		stack.push_back(entities[i]);
+		while (!stack.empty())
+		{
+			EntityID entity = stack.back();
+			stack.pop_back();
+			if (count > 1 && !gathered.insert(entity).second)
+				continue; // Its subtree is already gathered
+
+			batch.push_back(entity);
+			for (EntityID child = entityFirstChildren[entityPool.IndexOf(entity)];
+				child != 0;
+				child = entityNextSiblings[entityPool.IndexOf(child)])
 			{
-				EP_WARN("SceneManager::SaveEntitiesToTextFile(): EntityID {} does not exist!", id);
+				stack.push_back(child);
 			}
 		}
 	}
-	outYaml << YAML::EndMap; // Entities section
+	if (batch.empty())
+		return;
 
-	// Components
-	outYaml << YAML::Key << "Components" << YAML::Value << YAML::BeginMap;
-	for (const auto& [componentTypeName, tsf] : tsfs)
+	// Delete any attached components
+	for (size_t i = 0; i < dcfs.size(); i++)
 	{
-		outYaml << YAML::Key << HN_ToStr(componentTypeName) << YAML::Value << YAML::BeginMap;
-
-		if (entities.size() == 0)
+		if (bdcfs[i])
 		{
-			for (const auto& [id, index] : entityIndices)
-			{
-				YAML::Node callbackNode;
-				try
-				{
-					if (tsf(id, callbackNode))
-					{
-						outYaml << YAML::Key << id << YAML::Value << callbackNode;
-					}
-				}
-				catch (const YAML::Exception& except)
-				{
-					EP_ERROR("SceneManager::SaveEntitiesToTextFile(): YAML exception during {} serialization!  "
-						"Message: {}", HN_ToStr(componentTypeName), except.msg);
-				}
-			}
+			bdcfs[i](batch.data(), batch.size());
 		}
 		else
 		{
-			for (EntityID id : entities)
+			for (EntityID entity : batch)
 			{
-				YAML::Node callbackNode;
-				try
-				{
-					if (tsf(id, callbackNode))
-					{
-						outYaml << YAML::Key << id << YAML::Value << callbackNode;
-					}
-				}
-				catch (const YAML::Exception& except)
-				{
-					EP_ERROR("SceneManager::SaveEntitiesToTextFile(): YAML exception during {} serialization!  "
-						"Message: {}", HN_ToStr(componentTypeName), except.msg);
-				}
+				dcfs[i](entity);
 			}
 		}
+	}
 
-		outYaml << YAML::EndMap; // Component type section
+	// Mark entities as deleted
+	for (EntityID entity : batch)
+	{
+		if (isSpawnedID(entity))
+		{
+			releaseSpawnedEntityID(entity);
+		}
 	}
-	outYaml << YAML::EndMap; // Components section
+	removeEntities(batch.data(), batch.size());
 
-	outYaml << YAML::EndMap; // File-wide
-	File::SaveTextFile(path, outYaml.c_str());
+	Events::Dispatch(entitiesDeletedEvent, EntityList{ batch.data(), batch.size() });
 }
 
-bool SceneManager::LoadEntitiesFromYAML(const std::string& yamlSrc)
+void SceneManager::DeleteEntity(EntityID entity)
 {
-	try
+	if (entityPool.Contains(entity))
 	{
-		YAML::Node yamlIn = YAML::Load(yamlSrc);
+		DeleteEntities(&entity, 1);
+	}
+	else
+	{
+		EP_WARN("SceneManager::DeleteEntity(): EntityID {} does not exist!", entity);
+	}
+}
 
-		if (yamlIn.Type() != YAML::NodeType::Map)
+void SceneManager::PurgeSpawnedEntities()
+{
+	std::vector<EntityID> spawnedIDs;
+	for (size_t i = 0; i < entityPool.Size(); i++)
+	{
+		if (isSpawnedID(entityPool.EntityAt(i)))
 		{
-			EP_ERROR("SceneManager::LoadEntitiesFromYAML(): Root node is not a map node!");
-			return false;
+			spawnedIDs.push_back(entityPool.EntityAt(i));
 		}
-		if (!yamlIn["Entities"])
+	}
+	DeleteEntities(spawnedIDs.data(), spawnedIDs.size());
+}
+
+
+// Every thread's command buffer, in order of first use.  Buffers remove themselves when their thread exits.
+static std::mutex commandBuffersMutex;
+static std::vector<EntityCommandBuffer*> commandBuffers;
+
+// Registers the calling thread's command buffer on first use.
+struct ThreadCommandBuffer
+{
+	EntityCommandBuffer buffer;
+
+	ThreadCommandBuffer()
+	{
+		std::lock_guard<std::mutex> lock(commandBuffersMutex);
+		commandBuffers.push_back(&buffer);
+	}
+	~ThreadCommandBuffer()
+	{
+		if (!buffer.Empty())
 		{
-			EP_ERROR("SceneManager::LoadEntitiesFromYAML(): \"Entities\" key not present in root node!");
-			return false;
+			EP_WARN("SceneManager: A thread exited with unapplied entity commands.  Commands will be discarded.");
 		}
-		if (yamlIn["Entities"].Type() != YAML::NodeType::Map)
+
+		std::lock_guard<std::mutex> lock(commandBuffersMutex);
+		commandBuffers.erase(std::find(commandBuffers.begin(), commandBuffers.end(), &buffer));
+	}
+};
+
+EntityCommandBuffer& SceneManager::GetCommandBuffer()
+{
+	thread_local ThreadCommandBuffer threadBuffer;
+	return threadBuffer.buffer;
+}
+
+void SceneManager::ApplyCommandBuffers()
+{
+	// Take the recorded commands first, so that component callbacks can record new ones while these are applied
+	std::vector<EntityCommandBuffer> pending;
+	{
+		std::lock_guard<std::mutex> lock(commandBuffersMutex);
+		for (EntityCommandBuffer* buffer : commandBuffers)
 		{
-			EP_ERROR("SceneManager::LoadEntitiesFromYAML(): \"Entities\" key is not associated with a map node!");
-			return false;
+			if (!buffer->Empty())
+			{
+				pending.push_back(std::move(*buffer));
+				buffer->Clear();
+			}
 		}
+	}
+	if (pending.empty())
+		return;
 
-		std::map<EntityID, EntityID> oldIDtoNewID;
+	// Creations
+	std::vector<std::vector<EntityID>> createdIDs(pending.size());
+	for (size_t b = 0; b < pending.size(); b++)
+	{
+		createdIDs[b].reserve(pending[b].m_creates.size());
+		for (const EntityCommandBuffer::CreateCommand& create : pending[b].m_creates)
+		{
+			createdIDs[b].push_back(CreateEntity(create.name, create.position, create.rotation, create.scale));
+		}
+	}
 
-		// Entities
-		for (auto entityDataIt = yamlIn["Entities"].begin();
-			entityDataIt != yamlIn["Entities"].end();
-			entityDataIt++)
+	// Component changes, collecting deletions for a single batch
+	std::vector<EntityID> deletions;
+	for (size_t b = 0; b < pending.size(); b++)
+	{
+		const EntityCommandBuffer& buffer = pending[b];
+		for (const EntityCommandBuffer::Command& command : buffer.m_commands)
 		{
-			if (entityDataIt->second.Type() != YAML::NodeType::Map)
+			EntityID entity = command.entity;
+			if (EntityID_Generation(entity) == EntityCommandBuffer::PendingGeneration)
 			{
-				EP_WARN("SceneManager::LoadEntitiesFromYAML(): Entity subnode is not a mapping.  "
-					"ID: {}", entityDataIt->first.as<std::string>());
-			}
-			else if (!entityDataIt->second["Name"] ||
-				!entityDataIt->second["Position"] ||
-				!entityDataIt->second["Rotation"] ||
-				!entityDataIt->second["Scale"])
+				size_t createIndex = EntityID_Index(entity) - 1;
+				if (createIndex >= createdIDs[b].size())
+				{
+					EP_ERROR("SceneManager::ApplyCommandBuffers(): Pending EntityID {} was not created by the "
+						"buffer it was used with!", entity);
+					continue;
+				}
+				entity = createdIDs[b][createIndex];
+				if (entity == 0)
+					continue; // Creation failed and was already reported
+			}
+
+			if (command.type == EntityCommandBuffer::CommandType::Delete)
 			{
-				EP_WARN("SceneManager::LoadEntitiesFromYAML() : Entity subnode is missing data.  "
-					"ID : {}", entityDataIt->first.as<std::string>());
+				deletions.push_back(entity);
+				continue;
 			}
-			else
+			if (!entityPool.Contains(entity))
+			{
+				EP_WARN("SceneManager::ApplyCommandBuffers(): EntityID {} does not exist!  Component command for "
+					"type {} will be ignored.", entity, HN_ToStr(command.componentType));
+				continue;
+			}
+
+			switch (command.type)
 			{
-				if (entityDataIt->second["Position"].Type() != YAML::NodeType::Map ||
-					entityDataIt->second["Rotation"].Type() != YAML::NodeType::Map ||
-					entityDataIt->second["Scale"].Type() != YAML::NodeType::Map)
+			case EntityCommandBuffer::CommandType::AddComponentYAML:
+			{
+				auto tdfIt = tdfs.find(command.componentType);
+				if (tdfIt == tdfs.end())
 				{
-					EP_WARN("SceneManager::LoadEntitiesFromYAML() : \"Position\" or \"Rotation\" subvalues "
-						"for entity \"{}\" are not mappings.", entityDataIt->first.as<std::string>());
+					EP_WARN("SceneManager::ApplyCommandBuffers(): \"{}\" is not a valid component type.",
+						HN_ToStr(command.componentType));
+					break;
 				}
-				else if (!entityDataIt->second["Position"]["x"] ||
-					!entityDataIt->second["Position"]["y"] ||
-					!entityDataIt->second["Position"]["z"] ||
-					!entityDataIt->second["Rotation"]["w"] ||
-					!entityDataIt->second["Rotation"]["x"] ||
-					!entityDataIt->second["Rotation"]["y"] ||
-					!entityDataIt->second["Rotation"]["z"] ||
-					!entityDataIt->second["Scale"]["x"] ||
-					!entityDataIt->second["Scale"]["y"] ||
-					!entityDataIt->second["Scale"]["z"])
+				if (entityHasComponent(command.componentType, entity))
 				{
-					EP_WARN("SceneManager::LoadEntitiesFromYAML() : \"Position\" or \"Rotation\" subvalues "
-						"for entity \"{}\" are missing data.", entityDataIt->first.as<std::string>());
+					EP_ERROR("SceneManager::ApplyCommandBuffers(): Entity {} already has a {} component!  "
+						"The added component will be ignored.", entity, HN_ToStr(command.componentType));
+					break;
 				}
-				else
+				try
 				{
-					EntityID id;
-
-					try
-					{
-						// Non-string deserialization done first because they throw exceptions in case of failure
-						id = entityDataIt->first.as<EntityID>();
-						glm::vec3 outPos =
-						{
-							entityDataIt->second["Position"]["x"].as<float>(),
-							entityDataIt->second["Position"]["y"].as<float>(),
-							entityDataIt->second["Position"]["z"].as<float>()
-						};
-						glm::quat outRot =
-						{
-							entityDataIt->second["Rotation"]["w"].as<float>(),
-							entityDataIt->second["Rotation"]["x"].as<float>(),
-							entityDataIt->second["Rotation"]["y"].as<float>(),
-							entityDataIt->second["Rotation"]["z"].as<float>()
-						};
-						glm::vec3 outScale =
-						{
-							entityDataIt->second["Scale"]["x"].as<float>(),
-							entityDataIt->second["Scale"]["y"].as<float>(),
-							entityDataIt->second["Scale"]["z"].as<float>()
-						};
-
-
-						if (id <= Constants::MaxSpawnedEntities)
-							// Spawnable range ID: Always create new
-						{
-							oldIDtoNewID[id] = genSpawnedEntityID();
-							entityIndices[oldIDtoNewID[id]] = availableEntityPoolIndices.back();
-							availableEntityPoolIndices.pop_back();
-						}
-						else
-							// Scene file range ID: Update existing entity, if it exists
-						{
-							oldIDtoNewID[id] = id;
-
-							if (entityIndices.count(id))
-								// Entity in scene already: delete attached components
-							{
-								for (const DelComponentFn& dcf : dcfs)
-								{
-									dcf(id);
-								}
-							}
-							else
-								// Entity not in scene yet: create one
-							{
-								entityIndices[id] = availableEntityPoolIndices.back();
-								availableEntityPoolIndices.pop_back();
-							}
-						}
-
-						// Set entity data
-						entityPool[entityIndices[oldIDtoNewID[id]]].name = 
-							HN(entityDataIt->second["Name"].as<std::string>());
-						entityPool[entityIndices[oldIDtoNewID[id]]].position = outPos;
-						entityPool[entityIndices[oldIDtoNewID[id]]].rotation = outRot;
-						entityPool[entityIndices[oldIDtoNewID[id]]].scale = outScale;
-					}
-					catch (const YAML::TypedBadConversion<EntityID>&)
-					{
-						EP_WARN("SceneManager::LoadEntitiesFromYAML(): Invalid EntityID in entities list: {}",
-							entityDataIt->first.as<std::string>());
-					}
-					catch (const YAML::TypedBadConversion<float>& exc)
+					if (!tdfIt->second(entity, buffer.m_yamlData[command.payload]))
 					{
-						EP_WARN("SceneManager::LoadEntitiesFromYAML(): Cannot deserialize EntityID {}: "
-							"Invalid transform value(s).", id);
+						EP_WARN("SceneManager::ApplyCommandBuffers(): Could not add {} component to entity {}.",
+							HN_ToStr(command.componentType), entity);
 					}
 				}
+				catch (const YAML::Exception& except)
+				{
+					EP_ERROR("SceneManager::ApplyCommandBuffers(): YAML exception while adding {} component!  "
+						"Message: {}", HN_ToStr(command.componentType), except.msg);
+				}
+				break;
 			}
-		}
-
-		// Components
-		if (yamlIn["Components"])
-		{
-			if (yamlIn["Components"].Type() == YAML::NodeType::Map)
+			case EntityCommandBuffer::CommandType::AddComponentBinary:
 			{
-				for (auto componentTypeIt = yamlIn["Components"].begin();
-					componentTypeIt != yamlIn["Components"].end();
-					componentTypeIt++)
+				auto bdfIt = bdfs.find(command.componentType);
+				if (bdfIt == bdfs.end())
 				{
-					if (componentTypeIt->second.Type() == YAML::NodeType::Map)
-					{
-						HashName componentTypeName = HN(componentTypeIt->first.as<std::string>());
-						for (auto componentDataIt = componentTypeIt->second.begin();
-							componentDataIt != componentTypeIt->second.end();
-							componentDataIt++)
-						{
-							if (tdfs.count(componentTypeName))
-							{
-								try
-								{
-									EntityID id = componentDataIt->first.as<EntityID>();
-									if (oldIDtoNewID.count(id) != 0)
-									{
-										try
-										{
-											if (!tdfs[componentTypeName](oldIDtoNewID[id], componentDataIt->second))
-											{
-												EP_WARN("SceneManager::LoadEntitiesFromYAML(): "
-													"Could not deserialize {} component data for entity {}.",
-													HN_ToStr(componentTypeName), id);
-											}
-										}
-										catch (const YAML::Exception& except)
-										{
-											EP_ERROR("SceneManager::LoadEntitiesFromYAML(): "
-												"YAML exception during {} component deserialization!  Message: {}", 
-												HN_ToStr(componentTypeName), except.msg);
-										}
-									}
-									else
-									{
-										EP_WARN("SceneManager::LoadEntitiesFromYAML(): {} component data found for "
-											"EntityID that isn't present in \"Entities\" section!  Component will "
-											"not be loaded.  EntityID: {}", HN_ToStr(componentTypeName), id);
-									}
-								}
-								catch (const YAML::TypedBadConversion<EntityID>&)
-								{
-									EP_WARN("SceneManager::LoadEntitiesFromYAML(): "
-										"Invalid EntityID in \"{}\" component section: {}",
-										HN_ToStr(componentTypeName), componentDataIt->first.as<std::string>());
-								}
-							}
-							else
-							{
-								EP_WARN("SceneManager::LoadEntitiesFromYAML(): \"{}\" is not a valid component type.  "
-									"Did you register the required system using SceneManager::RegisterComponentType()?",
-									HN_ToStr(componentTypeName));
-							}
-						}
-					}
-					else
-					{
-						EP_WARN("SceneManager::LoadEntitiesFromYAML(): \"Components\" subkey \"{}\" is not associated"
-							" with a mapping!  \"{}\" components will not be deserialized.",
-							componentTypeIt->first.as<std::string>());
-					}
+					EP_WARN("SceneManager::ApplyCommandBuffers(): \"{}\" has no binary deserializer.",
+						HN_ToStr(command.componentType));
+					break;
+				}
+				if (entityHasComponent(command.componentType, entity))
+				{
+					EP_ERROR("SceneManager::ApplyCommandBuffers(): Entity {} already has a {} component!  "
+						"The added component will be ignored.", entity, HN_ToStr(command.componentType));
+					break;
 				}
+				if (!bdfIt->second(entity, buffer.m_binaryData.data() + command.payload, command.size))
+				{
+					EP_WARN("SceneManager::ApplyCommandBuffers(): Could not add {} component to entity {}.",
+						HN_ToStr(command.componentType), entity);
+				}
+				break;
 			}
-			else
+			case EntityCommandBuffer::CommandType::RemoveComponent:
 			{
-				EP_WARN("SceneManager::LoadEntitiesFromYAML(): \"Components\" key is not associated with a mapping!"
-					"  No component data can be read.");
+				auto indexIt = dcfIndices.find(command.componentType);
+				if (indexIt == dcfIndices.end())
+				{
+					EP_WARN("SceneManager::ApplyCommandBuffers(): \"{}\" is not a valid component type.",
+						HN_ToStr(command.componentType));
+					break;
+				}
+				dcfs[indexIt->second](entity);
+				break;
+			}
+			default:
+				break;
 			}
-		}
-		else
-		{
-			EP_WARN("SceneManager::LoadEntitiesFromYAML(): File does not contain \"Components\" section.");
 		}
 	}
-	catch (const YAML::Exception& e)
+
+	// Deletions
+	if (!deletions.empty())
+	{
+		DeleteEntities(deletions.data(), deletions.size());
+	}
+}
+
+
+bool SceneManager::SetEntityParent(EntityID entity, EntityID parent)
+{
+	if (!entityPool.Contains(entity))
+	{
+		EP_ERROR("SceneManager::SetEntityParent(): EntityID {} does not exist!", entity);
+		return false;
+	}
+	if (parent != 0 && !entityPool.Contains(parent))
 	{
-		EP_ERROR("SceneManager::LoadEntitiesFromYAML(): YAML exception thrown!  Message: {}", e.msg);
+		EP_ERROR("SceneManager::SetEntityParent(): Parent EntityID {} does not exist!", parent);
 		return false;
 	}
+	for (EntityID ancestor = parent; ancestor != 0; ancestor = entityParents[entityPool.IndexOf(ancestor)])
+	{
+		if (ancestor == entity)
+		{
+			EP_ERROR("SceneManager::SetEntityParent(): Parenting entity {} to {} would create a cycle!", entity, parent);
+			return false;
+		}
+	}
 
+	size_t index = entityPool.IndexOf(entity);
+	if (entityParents[index] != parent)
+	{
+		unlinkEntity(index);
+		if (parent != 0)
+		{
+			linkEntity(index, parent);
+		}
+	}
 	return true;
 }
 
-bool SceneManager::LoadEntitiesFromTextFile(const std::string& path)
+EntityID SceneManager::GetEntityParent(EntityID entity)
 {
-	std::string src;
-	if (File::LoadTextFile(path, &src) == File::ErrorCode::Success)
+	if (entityPool.Contains(entity))
 	{
-		bool result = LoadEntitiesFromYAML(src);
-		if (!result)
+		return entityParents[entityPool.IndexOf(entity)];
+	}
+	else
+	{
+		EP_ERROR("SceneManager::GetEntityParent(): EntityID {} does not exist!", entity);
+		return 0;
+	}
+}
+
+std::vector<EntityID> SceneManager::GetEntityChildren(EntityID entity)
+{
+	std::vector<EntityID> returnVal;
+	if (entityPool.Contains(entity))
+	{
+		for (EntityID child = entityFirstChildren[entityPool.IndexOf(entity)];
+			child != 0;
+			child = entityNextSiblings[entityPool.IndexOf(child)])
 		{
-			EP_ERROR("SceneManager::LoadEntitiesFromTextFile(): Failure loading entities from file \"{}\".", path);
+			returnVal.push_back(child);
 		}
-		return result;
 	}
 	else
 	{
-		return false;
+		EP_ERROR("SceneManager::GetEntityChildren(): EntityID {} does not exist!", entity);
 	}
+	return returnVal;
 }
 
 
-static std::vector<SceneManager::CoreCallFn> fixedUpdateCallbacks;
-static std::vector<SceneManager::CoreCallFn> updateCallbacks;
-static std::vector<SceneManager::CoreCallFn> predrawCallbacks;
-static std::vector<SceneManager::CoreCallFn> drawCallbacks;
+static size_t placeInWorldCache(size_t index, size_t parentSlot, size_t slot)
+	// Helper function: assigns an entity to a world transform cache slot.
+{
+	worldDenseIndices[slot] = index;
+	worldParentSlots[slot] = parentSlot;
+	entityWorldSlots[index] = slot;
+	return slot;
+}
 
-void SceneManager::RegisterFixedUpdateFn(CoreCallFn func)
+static void rebuildWorldOrder()
+	// Helper function: lays out the world transform cache in hierarchy preorder.  Every slot is flagged dirty.
 {
-	EP_ASSERT(func);
-	fixedUpdateCallbacks.push_back(func);
+	size_t count = entityPool.Size();
+	worldDenseIndices.resize(count);
+	worldParentSlots.resize(count);
+	worldSubtreeEnds.resize(count);
+	worldMatrices.resize(count);
+	worldInterpMatrices.resize(count);
+	worldDirtyFlags.assign(count, 1);
+
+	// Depth-first walk of each root's subtree, using the sibling links instead of a stack
+	size_t nextSlot = 0;
+	for (size_t root = 0; root < count; root++)
+	{
+		if (entityParents[root] != 0)
+			continue;
+
+		size_t current = root;
+		size_t currentSlot = placeInWorldCache(root, NoParentSlot, nextSlot++);
+		while (true)
+		{
+			if (entityFirstChildren[current] != 0)
+				// Descend
+			{
+				current = entityPool.IndexOf(entityFirstChildren[current]);
+				currentSlot = placeInWorldCache(current, currentSlot, nextSlot++);
+				continue;
+			}
+
+			// Close finished subtrees until a sibling is found or the root is closed
+			while (true)
+			{
+				worldSubtreeEnds[currentSlot] = nextSlot;
+				if (current == root)
+					break;
+
+				size_t parentSlot = worldParentSlots[currentSlot];
+				if (entityNextSiblings[current] != 0)
+				{
+					current = entityPool.IndexOf(entityNextSiblings[current]);
+					currentSlot = placeInWorldCache(current, parentSlot, nextSlot++);
+					break;
+				}
+				currentSlot = parentSlot;
+				current = worldDenseIndices[parentSlot];
+			}
+			if (current == root)
+				break;
+		}
+	}
+	EP_ASSERT(nextSlot == count);
+
+	worldMatricesDirty = true; // Set first, so the cache never briefly appears clean
+	worldOrderDirty = false;
 }
 
-void SceneManager::RegisterUpdateFn(CoreCallFn func)
+static inline glm::mat4 localMatrix(size_t index)
+	// Helper function: composes an entity's local transform matrix (translation * rotation * scale).
 {
-	EP_ASSERT(func);
-	updateCallbacks.push_back(func);
+	glm::mat4 returnVal = glm::mat4_cast(entityRotations[index]);
+	returnVal[0] *= entityScales[index].x;
+	returnVal[1] *= entityScales[index].y;
+	returnVal[2] *= entityScales[index].z;
+	returnVal[3] = glm::vec4(entityPositions[index], 1.0f);
+	return returnVal;
 }
 
-void SceneManager::RegisterPreDrawFn(CoreCallFn func)
+static void updateWorldTransforms()
+	// Helper function: recalculates world matrices for every dirty subtree.
 {
-	EP_ASSERT(func);
-	predrawCallbacks.push_back(func);
+	if (!worldOrderDirty && !worldMatricesDirty)
+		return;
+
+	std::lock_guard<std::mutex> lock(worldTransformMutex);
+	if (worldOrderDirty)
+	{
+		rebuildWorldOrder();
+	}
+	if (!worldMatricesDirty)
+		return;
+
+	for (size_t slot = 0; slot < worldDenseIndices.size(); )
+	{
+		if (!worldDirtyFlags[slot])
+		{
+			slot++;
+			continue;
+		}
+
+		// Parents precede children, so each parent matrix is final before its children need it
+		size_t subtreeEnd = worldSubtreeEnds[slot];
+		for (size_t i = slot; i < subtreeEnd; i++)
+		{
+			glm::mat4 local = localMatrix(worldDenseIndices[i]);
+			worldMatrices[i] = worldParentSlots[i] == NoParentSlot ? local : worldMatrices[worldParentSlots[i]] * local;
+			worldDirtyFlags[i] = 0;
+			updateGridEntry(worldDenseIndices[i], glm::vec3(worldMatrices[i][3]));
+		}
+		slot = subtreeEnd;
+	}
+
+	worldInterpDirty = true;
+	worldMatricesDirty = false;
 }
 
-void SceneManager::RegisterSceneDrawFn(CoreCallFn func)
+glm::mat4 SceneManager::GetEntityWorldMatrix(EntityID entity)
 {
-	EP_ASSERT(func);
-	drawCallbacks.push_back(func);
+	if (entityPool.Contains(entity))
+	{
+		updateWorldTransforms();
+		return worldMatrices[entityWorldSlots[entityPool.IndexOf(entity)]];
+	}
+	else
+	{
+		EP_ERROR("SceneManager::GetEntityWorldMatrix(): EntityID {} does not exist!", entity);
+		return glm::mat4(1.0f);
+	}
 }
 
+void SceneManager::GetEntityWorldMatrices(const EntityID* entities, size_t count, glm::mat4* outMatrices)
+{
+	EP_ASSERT(entities || count == 0);
+	EP_ASSERT(outMatrices || count == 0);
 
-void SceneManager::DrawScene()
+	updateWorldTransforms();
+	for (size_t i = 0; i < count; i++)
+	{
+		if (entityPool.Contains(entities[i]))
+		{
+			outMatrices[i] = worldMatrices[entityWorldSlots[entityPool.IndexOf(entities[i])]];
+		}
+		else
+		{
+			EP_ERROR("SceneManager::GetEntityWorldMatrices(): EntityID {} does not exist!", entities[i]);
+			outMatrices[i] = glm::mat4(1.0f);
+		}
+	}
+}
+
+
+void SceneManager::GetEntitiesChangedSince(uint32_t tick, std::vector<EntityID>& outEntities)
 {
-	for (CoreCallFn c : drawCallbacks)
+	outEntities.clear();
+	updateWorldTransforms();
+
+	// Walk the cache in preorder, so each entity inherits its parent's result
+	static std::vector<uint8_t> changedScratch;
+	changedScratch.resize(worldDenseIndices.size());
+	for (size_t slot = 0; slot < worldDenseIndices.size(); slot++)
 	{
-		c();
+		size_t index = worldDenseIndices[slot];
+		changedScratch[slot] = entityPool.ChangeTickAt(index) > tick ||
+			(worldParentSlots[slot] != NoParentSlot && changedScratch[worldParentSlots[slot]]);
+		if (changedScratch[slot])
+		{
+			outEntities.push_back(entityPool.EntityAt(index));
+		}
 	}
 }
 
+void SceneManager::GetEntitiesDeletedSince(uint32_t tick, std::vector<EntityID>& outEntities)
+{
+	entityPool.GetRemovedSince(tick, outEntities);
+}
 
-void SceneManager::Init()
+
+template <typename Fn>
+static void forEachGridCellInBox(glm::vec3 min, glm::vec3 max, Fn fn)
+	// Helper function: calls fn on every occupied cell overlapping a box.  Cells may contain entries outside the box.
 {
-	EP_ASSERT(Constants::MaxSpawnedEntities < Constants::MaxEntities);
+	int64_t minX = gridCoordOf(min.x), minY = gridCoordOf(min.y), minZ = gridCoordOf(min.z);
+	int64_t maxX = gridCoordOf(max.x), maxY = gridCoordOf(max.y), maxZ = gridCoordOf(max.z);
+	if (minX > maxX || minY > maxY || minZ > maxZ)
+		return;
 
-	for (size_t i = 0; i < Constants::MaxEntities; i++)
+	// Large boxes are cheaper to answer by visiting the occupied cells than by probing every covered cell
+	double coveredCells = double(maxX - minX + 1) * double(maxY - minY + 1) * double(maxZ - minZ + 1);
+	if (coveredCells > double(gridCells.size()))
 	{
-		availableEntityPoolIndices[i] = Constants::MaxEntities - 1 - i;
+		for (const auto& [key, cell] : gridCells)
+		{
+			fn(cell);
+		}
+		return;
 	}
-	for (size_t i = 0; i < Constants::MaxSpawnedEntities; i++)
+
+	for (int64_t x = minX; x <= maxX; x++)
 	{
-		availableSpawnedIDs[i] = Constants::MaxSpawnedEntities - i;
+		for (int64_t y = minY; y <= maxY; y++)
+		{
+			for (int64_t z = minZ; z <= maxZ; z++)
+			{
+				auto it = gridCells.find(gridKeyOf(x, y, z));
+				if (it != gridCells.end())
+				{
+					fn(it->second);
+				}
+			}
+		}
 	}
 }
 
-void SceneManager::FixedUpdate()
+void SceneManager::QueryEntitiesInRadius(glm::vec3 center, float radius, std::vector<EntityID>& outEntities)
+{
+	outEntities.clear();
+	updateWorldTransforms();
+
+	float radiusSquared = radius * radius;
+	forEachGridCellInBox(center - glm::vec3(radius), center + glm::vec3(radius),
+		[&](const std::vector<SpatialEntry>& cell)
+	{
+		for (const SpatialEntry& entry : cell)
+		{
+			glm::vec3 offset = entry.position - center;
+			if (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z <= radiusSquared)
+			{
+				outEntities.push_back(entry.entity);
+			}
+		}
+	});
+}
+
+void SceneManager::QueryEntitiesInBox(glm::vec3 min, glm::vec3 max, std::vector<EntityID>& outEntities)
+{
+	outEntities.clear();
+	updateWorldTransforms();
+
+	forEachGridCellInBox(min, max, [&](const std::vector<SpatialEntry>& cell)
+	{
+		for (const SpatialEntry& entry : cell)
+		{
+			if (entry.position.x >= min.x && entry.position.x <= max.x &&
+				entry.position.y >= min.y && entry.position.y <= max.y &&
+				entry.position.z >= min.z && entry.position.z <= max.z)
+			{
+				outEntities.push_back(entry.entity);
+			}
+		}
+	});
+}
+
+void SceneManager::QueryNearestEntities(glm::vec3 point, size_t count, std::vector<EntityID>& outEntities)
+{
+	outEntities.clear();
+	if (count == 0)
+		return;
+	updateWorldTransforms();
+
+	// Max-heap of the closest entries found so far, keyed on squared distance
+	std::vector<std::pair<float, EntityID>> nearest;
+	auto considerCell = [&](const std::vector<SpatialEntry>& cell)
+	{
+		for (const SpatialEntry& entry : cell)
+		{
+			glm::vec3 offset = entry.position - point;
+			float distanceSquared = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+			if (nearest.size() < count)
+			{
+				nearest.emplace_back(distanceSquared, entry.entity);
+				std::push_heap(nearest.begin(), nearest.end());
+			}
+			else if (distanceSquared < nearest.front().first)
+			{
+				std::pop_heap(nearest.begin(), nearest.end());
+				nearest.back() = { distanceSquared, entry.entity };
+				std::push_heap(nearest.begin(), nearest.end());
+			}
+		}
+	};
+
+	// Search outward in cubic shells of cells.  Entries outside shell r are at least r cells away from the point.
+	int64_t centerX = gridCoordOf(point.x), centerY = gridCoordOf(point.y), centerZ = gridCoordOf(point.z);
+	for (int64_t ring = 0; ; ring++)
+	{
+		double side = double(2 * ring + 1);
+		if (side * side * side > double(gridCells.size()))
+			// The shells now cover more cells than are occupied, so finish with a scan of the occupied cells
+		{
+			nearest.clear();
+			for (const auto& [key, cell] : gridCells)
+			{
+				considerCell(cell);
+			}
+			break;
+		}
+
+		for (int64_t x = centerX - ring; x <= centerX + ring; x++)
+		{
+			for (int64_t y = centerY - ring; y <= centerY + ring; y++)
+			{
+				// Interior columns only touch the shell at their ends
+				bool onShellFace = (x == centerX - ring || x == centerX + ring || y == centerY - ring || y == centerY + ring);
+				int64_t zStep = onShellFace || ring == 0 ? 1 : 2 * ring;
+				for (int64_t z = centerZ - ring; z <= centerZ + ring; z += zStep)
+				{
+					if (std::abs(x) > GridCoordLimit || std::abs(y) > GridCoordLimit || std::abs(z) > GridCoordLimit)
+						continue;
+
+					auto it = gridCells.find(gridKeyOf(x, y, z));
+					if (it != gridCells.end())
+					{
+						considerCell(it->second);
+					}
+				}
+			}
+		}
+
+		float searchedDistance = float(ring) * gridCellSize;
+		if (nearest.size() == count && nearest.front().first <= searchedDistance * searchedDistance)
+			break;
+	}
+
+	std::sort_heap(nearest.begin(), nearest.end());
+	outEntities.reserve(nearest.size());
+	for (const auto& [distanceSquared, entity] : nearest)
+	{
+		outEntities.push_back(entity);
+	}
+}
+
+
+bool SceneManager::IsEntityValid(EntityID entity)
+{
+	return entityPool.Contains(entity);
+}
+
+
+glm::vec3 SceneManager::GetEntityPosition(EntityID entity)
 {
-	for (CoreCallFn c : fixedUpdateCallbacks)
+	if (entityPool.Contains(entity))
+	{
+		return entityPositions[entityPool.IndexOf(entity)];
+	}
+	else
 	{
-		c();
+		EP_ERROR("SceneManager::GetEntityPosition(): EntityID {} does not exist!", entity);
+		return glm::vec3();
 	}
 }
 
-void SceneManager::Update()
+glm::quat SceneManager::GetEntityRotation(EntityID entity)
 {
-	for (CoreCallFn c : updateCallbacks)
+	if (entityPool.Contains(entity))
+	{
+		return entityRotations[entityPool.IndexOf(entity)];
+	}
+	else
 	{
-		c();
+		EP_ERROR("SceneManager::GetEntityRotation(): EntityID {} does not exist!", entity);
+		return glm::quat();
 	}
 }
 
-void SceneManager::PreDraw()
+glm::vec3 SceneManager::GetEntityScale(EntityID entity)
 {
-	for (CoreCallFn c : predrawCallbacks)
+	if (entityPool.Contains(entity))
 	{
-		c();
+		return entityScales[entityPool.IndexOf(entity)];
 	}
+	else
+	{
+		EP_ERROR("SceneManager::GetEntityScale(): EntityID {} does not exist!", entity);
+		return glm::vec3();
+	}
+}
+
+
+void SceneManager::SetEntityPosition(EntityID entity, glm::vec3 position)
+{
+	if (entityPool.Contains(entity))
+	{
+		size_t index = entityPool.IndexOf(entity);
+		entityPositions[index] = position;
+		transformChanged(index);
+	}
+	else
+	{
+		EP_ERROR("SceneManager::SetEntityPosition(): EntityID {} does not exist!", entity);
+	}
+}
+
+void SceneManager::SetEntityRotation(EntityID entity, glm::quat rotation)
+{
+	if (entityPool.Contains(entity))
+	{
+		size_t index = entityPool.IndexOf(entity);
+		entityRotations[index] = rotation;
+		transformChanged(index);
+	}
+	else
+	{
+		EP_ERROR("SceneManager::SetEntityRotation(): EntityID {} does not exist!", entity);
+	}
+}
+
+void SceneManager::SetEntityScale(EntityID entity, glm::vec3 scale)
+{
+	if (entityPool.Contains(entity))
+	{
+		size_t index = entityPool.IndexOf(entity);
+		entityScales[index] = scale;
+		transformChanged(index);
+	}
+	else
+	{
+		EP_ERROR("SceneManager::SetEntityScale(): EntityID {} does not exist!", entity);
+	}
+}
+
+
+void SceneManager::GetEntityTransforms(const EntityID* entities, size_t count,
+	glm::vec3* outPositions, glm::quat* outRotations, glm::vec3* outScales)
+{
+	EP_ASSERT(entities || count == 0);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (entityPool.Contains(entities[i]))
+		{
+			size_t index = entityPool.IndexOf(entities[i]);
+			if (outPositions) outPositions[i] = entityPositions[index];
+			if (outRotations) outRotations[i] = entityRotations[index];
+			if (outScales) outScales[i] = entityScales[index];
+		}
+		else
+		{
+			EP_ERROR("SceneManager::GetEntityTransforms(): EntityID {} does not exist!", entities[i]);
+			if (outPositions) outPositions[i] = glm::vec3();
+			if (outRotations) outRotations[i] = glm::quat();
+			if (outScales) outScales[i] = glm::vec3();
+		}
+	}
+}
+
+void SceneManager::SetEntityTransforms(const EntityID* entities, size_t count,
+	const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales)
+{
+	EP_ASSERT(entities || count == 0);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (entityPool.Contains(entities[i]))
+		{
+			size_t index = entityPool.IndexOf(entities[i]);
+			if (positions) entityPositions[index] = positions[i];
+			if (rotations) entityRotations[index] = rotations[i];
+			if (scales) entityScales[index] = scales[i];
+			transformChanged(index);
+		}
+		else
+		{
+			EP_ERROR("SceneManager::SetEntityTransforms(): EntityID {} does not exist!", entities[i]);
+		}
+	}
+}
+
+size_t SceneManager::GetTransformBlockCount()
+{
+	return entityPool.Entities().ChunkCount();
+}
+
+SceneManager::TransformBlock SceneManager::GetTransformBlock(size_t block)
+{
+	EP_ASSERT(block < GetTransformBlockCount());
+
+	return
+	{
+		entityPool.Entities().ChunkData(block),
+		entityPositions.ChunkData(block),
+		entityRotations.ChunkData(block),
+		entityScales.ChunkData(block),
+		entityPool.Entities().ChunkLength(block)
+	};
+}
+
+
+static void lerpPositions(const glm::vec3* from, const glm::vec3* to, size_t count, float t, glm::vec3* out)
+	// Helper function: linearly interpolates arrays of positions.
+{
+	// Treated as flat float arrays, so that the loop vectorizes
+	const float* a = reinterpret_cast<const float*>(from);
+	const float* b = reinterpret_cast<const float*>(to);
+	float* o = reinterpret_cast<float*>(out);
+	for (size_t i = 0; i < count * 3; i++)
+	{
+		o[i] = a[i] + (b[i] - a[i]) * t;
+	}
+}
+
+static void nlerpRotations(const glm::quat* from, const glm::quat* to, size_t count, float t, glm::quat* out)
+	// Helper function: interpolates arrays of rotations along the shortest arc, then renormalizes them.  Each
+	// quaternion fills one SIMD register, so the dot products and lengths are horizontal sums.
+{
+	static_assert(sizeof(glm::quat) == 4 * sizeof(float), "SceneManager: glm::quat must be four packed floats.");
+	const float* a = reinterpret_cast<const float*>(from);
+	const float* b = reinterpret_cast<const float*>(to);
+	float* o = reinterpret_cast<float*>(out);
+
+#if defined(EP_SCENE_SIMD_SSE2)
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const __m128 tv = _mm_set1_ps(t);
+	const __m128 ta = _mm_set1_ps(1.0f - t);
+	for (size_t i = 0; i < count * 4; i += 4)
+	{
+		__m128 qa = _mm_loadu_ps(a + i);
+		__m128 qb = _mm_loadu_ps(b + i);
+
+		// Sum across lanes, leaving the total in every lane
+		__m128 dot = _mm_mul_ps(qa, qb);
+		dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+		dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+		__m128 tb = _mm_xor_ps(tv, _mm_and_ps(dot, signBit)); // -t when the dot product is negative
+
+		__m128 q = _mm_add_ps(_mm_mul_ps(qa, ta), _mm_mul_ps(qb, tb));
+		__m128 lengthSq = _mm_mul_ps(q, q);
+		lengthSq = _mm_add_ps(lengthSq, _mm_shuffle_ps(lengthSq, lengthSq, _MM_SHUFFLE(2, 3, 0, 1)));
+		lengthSq = _mm_add_ps(lengthSq, _mm_shuffle_ps(lengthSq, lengthSq, _MM_SHUFFLE(1, 0, 3, 2)));
+		_mm_storeu_ps(o + i, _mm_div_ps(q, _mm_sqrt_ps(lengthSq)));
+	}
+#elif defined(EP_SCENE_SIMD_NEON)
+	float ta = 1.0f - t;
+	for (size_t i = 0; i < count * 4; i += 4)
+	{
+		float32x4_t qa = vld1q_f32(a + i);
+		float32x4_t qb = vld1q_f32(b + i);
+
+		float tb = vaddvq_f32(vmulq_f32(qa, qb)) < 0.0f ? -t : t;
+		float32x4_t q = vmlaq_n_f32(vmulq_n_f32(qa, ta), qb, tb);
+		float32x4_t length = vdupq_n_f32(std::sqrt(vaddvq_f32(vmulq_f32(q, q))));
+		vst1q_f32(o + i, vdivq_f32(q, length));
+	}
+#else
+	for (size_t i = 0; i < count * 4; i += 4)
+	{
+		float dot = a[i] * b[i] + a[i + 1] * b[i + 1] + a[i + 2] * b[i + 2] + a[i + 3] * b[i + 3];
+		float tb = dot < 0.0f ? -t : t;
+		float ta = 1.0f - t;
+
+		float x = a[i] * ta + b[i] * tb;
+		float y = a[i + 1] * ta + b[i + 1] * tb;
+		float z = a[i + 2] * ta + b[i + 2] * tb;
+		float w = a[i + 3] * ta + b[i + 3] * tb;
+		float invLength = 1.0f / std::sqrt(x * x + y * y + z * z + w * w);
+
+		o[i] = x * invLength;
+		o[i + 1] = y * invLength;
+		o[i + 2] = z * invLength;
+		o[i + 3] = w * invLength;
+	}
+#endif
+}
+
+void SceneManager::GetInterpolatedTransformBlock(size_t block, glm::vec3* outPositions, glm::quat* outRotations)
+{
+	EP_ASSERT(block < GetTransformBlockCount());
+
+	float t = Time::FixedFrameInterp();
+	size_t count = entityPool.Entities().ChunkLength(block);
+	if (outPositions)
+	{
+		lerpPositions(entityPrevPositions.ChunkData(block), entityPositions.ChunkData(block), count, t, outPositions);
+	}
+	if (outRotations)
+	{
+		nlerpRotations(entityPrevRotations.ChunkData(block), entityRotations.ChunkData(block), count, t, outRotations);
+	}
+}
+
+void SceneManager::GetInterpolatedEntityTransforms(const EntityID* entities, size_t count,
+	glm::vec3* outPositions, glm::quat* outRotations)
+{
+	float t = Time::FixedFrameInterp();
+	for (size_t i = 0; i < count; i++)
+	{
+		if (entityPool.Contains(entities[i]))
+		{
+			size_t index = entityPool.IndexOf(entities[i]);
+			if (outPositions)
+			{
+				lerpPositions(&entityPrevPositions[index], &entityPositions[index], 1, t, &outPositions[i]);
+			}
+			if (outRotations)
+			{
+				nlerpRotations(&entityPrevRotations[index], &entityRotations[index], 1, t, &outRotations[i]);
+			}
+		}
+		else
+		{
+			EP_ERROR("SceneManager::GetInterpolatedEntityTransforms(): EntityID {} does not exist!", entities[i]);
+			if (outPositions) outPositions[i] = glm::vec3();
+			if (outRotations) outRotations[i] = glm::quat();
+		}
+	}
+}
+
+static inline glm::mat4 interpolatedLocalMatrix(size_t index, float t)
+	// Helper function: composes an entity's local transform matrix from its interpolated position and rotation.
+{
+	glm::vec3 position;
+	glm::quat rotation;
+	lerpPositions(&entityPrevPositions[index], &entityPositions[index], 1, t, &position);
+	nlerpRotations(&entityPrevRotations[index], &entityRotations[index], 1, t, &rotation);
+
+	glm::mat4 returnVal = glm::mat4_cast(rotation);
+	returnVal[0] *= entityScales[index].x;
+	returnVal[1] *= entityScales[index].y;
+	returnVal[2] *= entityScales[index].z;
+	returnVal[3] = glm::vec4(position, 1.0f);
+	return returnVal;
+}
+
+static void updateInterpolatedWorldTransforms()
+	// Helper function: recalculates the interpolated world matrices, if any transform or the interpolation fraction
+	// has changed since they were last calculated.  Uses the same preorder layout as the world transform cache.
+{
+	updateWorldTransforms();
+
+	float t = Time::FixedFrameInterp();
+	if (!worldInterpDirty && t == worldInterpFraction)
+		return;
+
+	std::lock_guard<std::mutex> lock(worldTransformMutex);
+	if (!worldInterpDirty && t == worldInterpFraction)
+		return;
+
+	// Parents precede children, so each parent matrix is final before its children need it
+	for (size_t i = 0; i < worldDenseIndices.size(); i++)
+	{
+		glm::mat4 local = interpolatedLocalMatrix(worldDenseIndices[i], t);
+		worldInterpMatrices[i] = worldParentSlots[i] == NoParentSlot ? local :
+			worldInterpMatrices[worldParentSlots[i]] * local;
+	}
+
+	worldInterpFraction = t;
+	worldInterpDirty = false;
+}
+
+void SceneManager::GetEntityInterpolatedWorldMatrices(const EntityID* entities, size_t count, glm::mat4* outMatrices)
+{
+	EP_ASSERT(entities || count == 0);
+	EP_ASSERT(outMatrices || count == 0);
+
+	updateInterpolatedWorldTransforms();
+	for (size_t i = 0; i < count; i++)
+	{
+		if (entityPool.Contains(entities[i]))
+		{
+			outMatrices[i] = worldInterpMatrices[entityWorldSlots[entityPool.IndexOf(entities[i])]];
+		}
+		else
+		{
+			EP_ERROR("SceneManager::GetEntityInterpolatedWorldMatrices(): EntityID {} does not exist!", entities[i]);
+			outMatrices[i] = glm::mat4(1.0f);
+		}
+	}
+}
+
+
+std::vector<EntityID> SceneManager::GetEntitiesWithComponent(HashName componentType)
+{
+	if (qcfs.count(componentType) != 0)
+	{
+		return qcfs[componentType]();
+	}
+	else
+	{
+		EP_ERROR("SceneManager::GetEntitiesWithComponent(): \"{}\" is not a valid component type.  "
+			"Did you register the required system using SceneManager::RegisterComponentType()?",
+			HN_ToStr(componentType));
+		return {};
+	}
+}
+
+
+static void emitEntityYAML(YAML::Emitter& outYaml, EntityID id, size_t index)
+	// Helper function: writes the entity table entry of one entity to a text scene.
+{
+	outYaml << YAML::Key << id << YAML::Value << YAML::BeginMap;
+	outYaml << YAML::Key << "Name" << YAML::Value << HN_ToStr(entityPool.ValueAt(index));
+	outYaml << YAML::Key << "Position" << YAML::Value << YAML::BeginMap;
+	outYaml << YAML::Key << "x" << YAML::Value << entityPositions[index].x;
+	outYaml << YAML::Key << "y" << YAML::Value << entityPositions[index].y;
+	outYaml << YAML::Key << "z" << YAML::Value << entityPositions[index].z;
+	outYaml << YAML::EndMap;
+	outYaml << YAML::Key << "Rotation" << YAML::Value << YAML::BeginMap;
+	outYaml << YAML::Key << "w" << YAML::Value << entityRotations[index].w;
+	outYaml << YAML::Key << "x" << YAML::Value << entityRotations[index].x;
+	outYaml << YAML::Key << "y" << YAML::Value << entityRotations[index].y;
+	outYaml << YAML::Key << "z" << YAML::Value << entityRotations[index].z;
+	outYaml << YAML::EndMap;
+	outYaml << YAML::Key << "Scale" << YAML::Value << YAML::BeginMap;
+	outYaml << YAML::Key << "x" << YAML::Value << entityScales[index].x;
+	outYaml << YAML::Key << "y" << YAML::Value << entityScales[index].y;
+	outYaml << YAML::Key << "z" << YAML::Value << entityScales[index].z;
+	outYaml << YAML::EndMap;
+	if (entityParents[index] != 0)
+	{
+		outYaml << YAML::Key << "Parent" << YAML::Value << entityParents[index];
+	}
+	outYaml << YAML::EndMap;
+}
+
+void SceneManager::SaveEntitiesToTextFile(std::string path, const std::vector<EntityID>& entities)
+{
+	// Emit entities in ascending ID order, so that saved scenes are stable regardless of pool layout
+	std::vector<EntityID> allIDs;
+	if (entities.size() == 0)
+	{
+		allIDs.reserve(entityPool.Size());
+		for (size_t i = 0; i < entityPool.Size(); i++)
+		{
+			allIDs.push_back(entityPool.EntityAt(i));
+		}
+		std::sort(allIDs.begin(), allIDs.end());
+	}
+
+	YAML::Emitter outYaml;
+	outYaml << YAML::BeginMap; // File-wide
+
+	// Entities
+	outYaml << YAML::Key << "Entities" << YAML::Value << YAML::BeginMap;
+	if (entities.size() == 0)
+	{
+		for (EntityID id : allIDs)
+		{
+			emitEntityYAML(outYaml, id, entityPool.IndexOf(id));
+		}
+	}
+	else
+	{
+		for (EntityID id : entities)
+		{
+			if (entityPool.Contains(id))
+			{
+				emitEntityYAML(outYaml, id, entityPool.IndexOf(id));
+			}
+			else
+			{
+				EP_WARN("SceneManager::SaveEntitiesToTextFile(): EntityID {} does not exist!", id);
+			}
+		}
+	}
+	outYaml << YAML::EndMap; // Entities section
+
+	// Components
+	outYaml << YAML::Key << "Components" << YAML::Value << YAML::BeginMap;
+	for (const auto& [componentTypeName, tsf] : tsfs)
+	{
+		outYaml << YAML::Key << HN_ToStr(componentTypeName) << YAML::Value << YAML::BeginMap;
+
+		if (entities.size() == 0)
+		{
+			for (EntityID id : allIDs)
+			{
+				YAML::Node callbackNode;
+				try
+				{
+					if (tsf(id, callbackNode))
+					{
+						outYaml << YAML::Key << id << YAML::Value << callbackNode;
+					}
+				}
+				catch (const YAML::Exception& except)
+				{
+					EP_ERROR("SceneManager::SaveEntitiesToTextFile(): YAML exception during {} serialization!  "
+						"Message: {}", HN_ToStr(componentTypeName), except.msg);
+				}
+			}
+		}
+		else
+		{
+			for (EntityID id : entities)
+			{
+				YAML::Node callbackNode;
+				try
+				{
+					if (tsf(id, callbackNode))
+					{
+						outYaml << YAML::Key << id << YAML::Value << callbackNode;
+					}
+				}
+				catch (const YAML::Exception& except)
+				{
+					EP_ERROR("SceneManager::SaveEntitiesToTextFile(): YAML exception during {} serialization!  "
+						"Message: {}", HN_ToStr(componentTypeName), except.msg);
+				}
+			}
+		}
+
+		outYaml << YAML::EndMap; // Component type section
+	}
+	outYaml << YAML::EndMap; // Components section
+
+	outYaml << YAML::EndMap; // File-wide
+	File::SaveTextFile(path, outYaml.c_str());
+}
+
+static EntityID prepareLoadedEntity(EntityID id, const char* caller)
+	// Helper function: gets the EntityID a serialized entity will have in the scene, creating the entity or clearing
+	// its components as needed.  Returns 0 if the entity should not be loaded.
+{
+	if (isSpawnedID(id))
+		// Spawnable range ID: Always create new
+	{
+		EntityID newID = genSpawnedEntityID();
+		if (newID == 0)
+		{
+			EP_ERROR("{}: All {} spawned EntityIDs are in use!  Entity {} will not be loaded.",
+				caller, spawnedIDRange, id);
+			return 0;
+		}
+		addEntity(newID, HN_NULL, glm::vec3(), glm::quat(), glm::vec3());
+		return newID;
+	}
+	else if (EntityID_Generation(id) != 0)
+		// Scene file range IDs are never recycled, so they never carry a generation
+	{
+		EP_WARN("{}: EntityID {} is outside of the spawned range but has a nonzero generation.  "
+			"Entity will not be loaded.", caller, id);
+		return 0;
+	}
+	else
+		// Scene file range ID: Update existing entity, if it exists
+	{
+		if (entityPool.Contains(id))
+			// Entity in scene already: delete attached components
+		{
+			for (const SceneManager::DelComponentFn& dcf : dcfs)
+			{
+				dcf(id);
+			}
+		}
+		else
+			// Entity not in scene yet: create one
+		{
+			addEntity(id, HN_NULL, glm::vec3(), glm::quat(), glm::vec3());
+		}
+		return id;
+	}
+}
+
+static void setLoadedEntityParent(EntityID entity, EntityID serializedParent, EntityID loadedParent, const char* caller)
+	// Helper function: restores the parent of a loaded entity.  loadedParent is the EntityID the parent was loaded
+	// with, or 0 if the parent was not part of the loaded data.
+{
+	EntityID parent = entityPool.Contains(loadedParent) ? loadedParent : 0;
+	if (parent == 0 && !isSpawnedID(serializedParent) && entityPool.Contains(serializedParent))
+		// Parent is a scene file entity which is already in the scene
+	{
+		parent = serializedParent;
+	}
+
+	if (parent == 0)
+	{
+		EP_WARN("{}: Parent {} of entity {} is not in the scene.  Entity will be loaded without a parent.",
+			caller, serializedParent, entity);
+	}
+	else if (!SceneManager::SetEntityParent(entity, parent))
+	{
+		EP_WARN("{}: Could not restore parent {} of entity {}.", caller, serializedParent, entity);
+	}
+}
+
+// A scene parsed from YAML.  Parsing does not touch engine state, so it can run on a worker thread.  Warnings are
+// collected for logging on the main thread.
+struct ParsedScene
+{
+	struct Entity
+	{
+		EntityID id;
+		std::string name;
+		glm::vec3 position;
+		glm::quat rotation;
+		glm::vec3 scale;
+		EntityID parent = 0;
+	};
+	struct Component
+	{
+		EntityID id;
+		YAML::Node data;
+	};
+	struct ComponentType
+	{
+		std::string name;
+		std::vector<Component> components;
+		bool deserializedInParallel = false;
+	};
+
+	std::vector<Entity> entities;
+	std::vector<ComponentType> componentTypes;
+	size_t componentCount = 0;
+	std::vector<std::string> warnings;
+	std::string error; // Set when the scene can't be loaded at all
+};
+
+// Progress through applying a ParsedScene to the scene.
+struct ParsedSceneApplyState
+{
+	std::map<EntityID, EntityID> oldIDtoNewID;
+	size_t nextEntity = 0;
+	size_t nextLink = 0;
+	size_t nextComponentType = 0;
+	size_t nextComponent = 0;
+	size_t itemsApplied = 0;
+};
+
+static bool parseSceneYAML(const std::string& yamlSrc, ParsedScene& scene)
+	// Helper function: parses a YAML scene without modifying engine state.  Safe to call from any thread.
+{
+	try
+	{
+		YAML::Node yamlIn = YAML::Load(yamlSrc);
+
+		if (yamlIn.Type() != YAML::NodeType::Map)
+		{
+			scene.error = "Root node is not a map node!";
+			return false;
+		}
+		if (!yamlIn["Entities"])
+		{
+			scene.error = "\"Entities\" key not present in root node!";
+			return false;
+		}
+		if (yamlIn["Entities"].Type() != YAML::NodeType::Map)
+		{
+			scene.error = "\"Entities\" key is not associated with a map node!";
+			return false;
+		}
+
+		// Entities
+		scene.entities.reserve(yamlIn["Entities"].size());
+		for (auto entityDataIt = yamlIn["Entities"].begin();
+			entityDataIt != yamlIn["Entities"].end();
+			entityDataIt++)
+		{
+			if (entityDataIt->second.Type() != YAML::NodeType::Map)
+			{
+				scene.warnings.push_back("Entity subnode is not a mapping.  ID: " +
+					entityDataIt->first.as<std::string>());
+			}
+			else if (!entityDataIt->second["Name"] ||
+				!entityDataIt->second["Position"] ||
+				!entityDataIt->second["Rotation"] ||
+				!entityDataIt->second["Scale"])
+			{
+				scene.warnings.push_back("Entity subnode is missing data.  ID: " +
+					entityDataIt->first.as<std::string>());
+			}
+			else if (entityDataIt->second["Position"].Type() != YAML::NodeType::Map ||
+				entityDataIt->second["Rotation"].Type() != YAML::NodeType::Map ||
+				entityDataIt->second["Scale"].Type() != YAML::NodeType::Map)
+			{
+				scene.warnings.push_back("\"Position\" or \"Rotation\" subvalues for entity \"" +
+					entityDataIt->first.as<std::string>() + "\" are not mappings.");
+			}
+			else if (!entityDataIt->second["Position"]["x"] ||
+				!entityDataIt->second["Position"]["y"] ||
+				!entityDataIt->second["Position"]["z"] ||
+				!entityDataIt->second["Rotation"]["w"] ||
+				!entityDataIt->second["Rotation"]["x"] ||
+				!entityDataIt->second["Rotation"]["y"] ||
+				!entityDataIt->second["Rotation"]["z"] ||
+				!entityDataIt->second["Scale"]["x"] ||
+				!entityDataIt->second["Scale"]["y"] ||
+				!entityDataIt->second["Scale"]["z"])
+			{
+				scene.warnings.push_back("Transform data for entity \"" +
+					entityDataIt->first.as<std::string>() + "\" is incomplete.");
+			}
+			else
+			{
+				try
+				{
+					ParsedScene::Entity entity;
+					entity.id = entityDataIt->first.as<EntityID>();
+					try
+					{
+						entity.name = entityDataIt->second["Name"].as<std::string>();
+						entity.position =
+						{
+							entityDataIt->second["Position"]["x"].as<float>(),
+							entityDataIt->second["Position"]["y"].as<float>(),
+							entityDataIt->second["Position"]["z"].as<float>()
+						};
+						entity.rotation =
+						{
+							entityDataIt->second["Rotation"]["w"].as<float>(),
+							entityDataIt->second["Rotation"]["x"].as<float>(),
+							entityDataIt->second["Rotation"]["y"].as<float>(),
+							entityDataIt->second["Rotation"]["z"].as<float>()
+						};
+						entity.scale =
+						{
+							entityDataIt->second["Scale"]["x"].as<float>(),
+							entityDataIt->second["Scale"]["y"].as<float>(),
+							entityDataIt->second["Scale"]["z"].as<float>()
+						};
+						if (entityDataIt->second["Parent"])
+						{
+							try
+							{
+								entity.parent = entityDataIt->second["Parent"].as<EntityID>();
+							}
+							catch (const YAML::TypedBadConversion<EntityID>&)
+							{
+								scene.warnings.push_back("Invalid parent EntityID for entity " +
+									std::to_string(entity.id) + ".  Entity will be loaded without a parent.");
+							}
+						}
+						scene.entities.push_back(std::move(entity));
+					}
+					catch (const YAML::TypedBadConversion<float>&)
+					{
+						scene.warnings.push_back("Cannot deserialize EntityID " + std::to_string(entity.id) +
+							": Invalid transform value(s).");
+					}
+				}
+				catch (const YAML::TypedBadConversion<EntityID>&)
+				{
+					scene.warnings.push_back("Invalid EntityID in entities list: " +
+						entityDataIt->first.as<std::string>());
+				}
+			}
+		}
+
+		// Components
+		if (!yamlIn["Components"])
+		{
+			scene.warnings.push_back("File does not contain \"Components\" section.");
+		}
+		else if (yamlIn["Components"].Type() != YAML::NodeType::Map)
+		{
+			scene.warnings.push_back("\"Components\" key is not associated with a mapping!  "
+				"No component data can be read.");
+		}
+		else
+		{
+			for (auto componentTypeIt = yamlIn["Components"].begin();
+				componentTypeIt != yamlIn["Components"].end();
+				componentTypeIt++)
+			{
+				std::string componentTypeName = componentTypeIt->first.as<std::string>();
+				if (componentTypeIt->second.Type() != YAML::NodeType::Map)
+				{
+					scene.warnings.push_back("\"Components\" subkey \"" + componentTypeName + "\" is not associated "
+						"with a mapping!  \"" + componentTypeName + "\" components will not be deserialized.");
+					continue;
+				}
+
+				ParsedScene::ComponentType& componentType = scene.componentTypes.emplace_back();
+				componentType.name = componentTypeName;
+				componentType.components.reserve(componentTypeIt->second.size());
+				for (auto componentDataIt = componentTypeIt->second.begin();
+					componentDataIt != componentTypeIt->second.end();
+					componentDataIt++)
+				{
+					try
+					{
+						componentType.components.push_back(
+							{ componentDataIt->first.as<EntityID>(), componentDataIt->second });
+					}
+					catch (const YAML::TypedBadConversion<EntityID>&)
+					{
+						scene.warnings.push_back("Invalid EntityID in \"" + componentTypeName + "\" component "
+							"section: " + componentDataIt->first.as<std::string>());
+					}
+				}
+				scene.componentCount += componentType.components.size();
+			}
+		}
+	}
+	catch (const YAML::Exception& e)
+	{
+		scene.error = "YAML exception thrown!  Message: " + e.msg;
+		return false;
+	}
+
+	return true;
+}
+
+static bool parallelDeserialization = false;
+static std::set<HashName> parallelDeserializableTypes;
+
+void SceneManager::AllowParallelDeserialization(HashName name)
+{
+	EP_ASSERTF(tdfs.count(name) != 0, "SceneManager: Component type must be registered before enabling parallel "
+		"deserialization!");
+	parallelDeserializableTypes.insert(name);
+}
+
+void SceneManager::SetParallelDeserialization(bool enabled)
+{
+	parallelDeserialization = enabled;
+}
+
+// Deserializes every component of one type on a worker thread.  Log messages are collected and emitted after the
+// worker is joined, so output does not depend on thread timing.
+struct ParallelComponentJob
+{
+	std::thread thread;
+	std::vector<std::pair<bool, std::string>> messages; // first is true for errors
+};
+
+static void launchParallelComponentJobs(ParsedScene& scene, const ParsedSceneApplyState& state,
+	std::vector<ParallelComponentJob>& jobs)
+	// Helper function: starts a worker for each component type that allows parallel deserialization.
+{
+	size_t jobCount = 0;
+	for (ParsedScene::ComponentType& componentType : scene.componentTypes)
+	{
+		HashName componentTypeName = HN(componentType.name);
+		componentType.deserializedInParallel =
+			parallelDeserializableTypes.count(componentTypeName) != 0 && tdfs.count(componentTypeName) != 0;
+		jobCount += componentType.deserializedInParallel;
+	}
+	if (jobCount < 2)
+	{
+		// A single worker would only add thread overhead
+		for (ParsedScene::ComponentType& componentType : scene.componentTypes)
+		{
+			componentType.deserializedInParallel = false;
+		}
+		return;
+	}
+
+	jobs.reserve(jobCount); // Workers hold pointers into jobs
+	for (const ParsedScene::ComponentType& componentType : scene.componentTypes)
+	{
+		if (!componentType.deserializedInParallel)
+			continue;
+
+		ParallelComponentJob& job = jobs.emplace_back();
+		SceneManager::TextDeserializeFn tdf = tdfs[HN(componentType.name)];
+		job.thread = std::thread([&componentType, tdf, &oldIDtoNewID = state.oldIDtoNewID, &job]()
+		{
+			for (const ParsedScene::Component& component : componentType.components)
+			{
+				auto idIt = oldIDtoNewID.find(component.id);
+				if (idIt == oldIDtoNewID.end())
+				{
+					job.messages.emplace_back(false, componentType.name + " component data found for EntityID that "
+						"isn't present in \"Entities\" section!  Component will not be loaded.  EntityID: " +
+						std::to_string(component.id));
+					continue;
+				}
+
+				try
+				{
+					if (!tdf(idIt->second, component.data))
+					{
+						job.messages.emplace_back(false, "Could not deserialize " + componentType.name +
+							" component data for entity " + std::to_string(component.id) + ".");
+					}
+				}
+				catch (const YAML::Exception& except)
+				{
+					job.messages.emplace_back(true, "YAML exception during " + componentType.name +
+						" component deserialization!  Message: " + except.msg);
+				}
+			}
+		});
+	}
+}
+
+static inline bool pastDeadline(std::chrono::steady_clock::time_point deadline)
+{
+	return deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= deadline;
+}
+
+static bool applyParsedScene(ParsedScene& scene, ParsedSceneApplyState& state, const char* caller,
+	std::chrono::steady_clock::time_point deadline)
+	// Helper function: adds the entities, then the components, of a parsed scene to the scene until everything has
+	// been applied or the deadline passes.  At least one item is applied per call.  Returns true when finished.
+{
+	while (state.nextEntity < scene.entities.size())
+	{
+		const ParsedScene::Entity& entity = scene.entities[state.nextEntity++];
+		EntityID newID = prepareLoadedEntity(entity.id, caller);
+		if (newID != 0)
+		{
+			state.oldIDtoNewID[entity.id] = newID;
+
+			size_t index = entityPool.IndexOf(newID);
+			entityPool.ValueAt(index) = HN(entity.name);
+			entityPositions[index] = entity.position;
+			entityRotations[index] = entity.rotation;
+			entityScales[index] = entity.scale;
+			unlinkEntity(index); // Parents are restored once every entity exists
+			transformChanged(index);
+		}
+
+		state.itemsApplied++;
+		if (pastDeadline(deadline))
+			return false;
+	}
+
+	while (state.nextLink < scene.entities.size())
+	{
+		const ParsedScene::Entity& entity = scene.entities[state.nextLink++];
+		auto idIt = state.oldIDtoNewID.find(entity.id);
+		// Entities loaded by an earlier call may have been deleted since
+		if (idIt != state.oldIDtoNewID.end() && entity.parent != 0 && entityPool.Contains(idIt->second))
+		{
+			auto parentIt = state.oldIDtoNewID.find(entity.parent);
+			setLoadedEntityParent(idIt->second, entity.parent,
+				parentIt != state.oldIDtoNewID.end() ? parentIt->second : 0, caller);
+		}
+
+		if (pastDeadline(deadline))
+			return false;
+	}
+
+	// Parallel deserialization is only used when the whole scene is applied at once
+	std::vector<ParallelComponentJob> parallelJobs;
+	if (parallelDeserialization && deadline == std::chrono::steady_clock::time_point::max() &&
+		state.nextComponentType == 0 && state.nextComponent == 0)
+	{
+		launchParallelComponentJobs(scene, state, parallelJobs);
+	}
+
+	while (state.nextComponentType < scene.componentTypes.size())
+	{
+		ParsedScene::ComponentType& componentType = scene.componentTypes[state.nextComponentType];
+		if (componentType.deserializedInParallel)
+		{
+			state.itemsApplied += componentType.components.size();
+			state.nextComponentType++;
+			continue;
+		}
+
+		HashName componentTypeName = HN(componentType.name);
+
+		auto tdfIt = tdfs.find(componentTypeName);
+		if (tdfIt == tdfs.end())
+		{
+			EP_WARN("{}: \"{}\" is not a valid component type.  "
+				"Did you register the required system using SceneManager::RegisterComponentType()?",
+				caller, componentType.name);
+			state.itemsApplied += componentType.components.size() - state.nextComponent;
+			state.nextComponent = componentType.components.size();
+		}
+
+		while (state.nextComponent < componentType.components.size())
+		{
+			const ParsedScene::Component& component = componentType.components[state.nextComponent++];
+			auto idIt = state.oldIDtoNewID.find(component.id);
+			if (idIt != state.oldIDtoNewID.end())
+			{
+				if (!entityPool.Contains(idIt->second))
+					// Deleted since it was loaded by an earlier call
+				{
+					state.itemsApplied++;
+					continue;
+				}
+
+				try
+				{
+					if (!tdfIt->second(idIt->second, component.data))
+					{
+						EP_WARN("{}: Could not deserialize {} component data for entity {}.",
+							caller, componentType.name, component.id);
+					}
+				}
+				catch (const YAML::Exception& except)
+				{
+					EP_ERROR("{}: YAML exception during {} component deserialization!  Message: {}",
+						caller, componentType.name, except.msg);
+				}
+			}
+			else
+			{
+				EP_WARN("{}: {} component data found for EntityID that isn't present in \"Entities\" section!  "
+					"Component will not be loaded.  EntityID: {}", caller, componentType.name, component.id);
+			}
+
+			state.itemsApplied++;
+			if (pastDeadline(deadline))
+				return false;
+		}
+
+		state.nextComponent = 0;
+		state.nextComponentType++;
+	}
+
+	// Workers are joined and their messages logged in component type order
+	for (ParallelComponentJob& job : parallelJobs)
+	{
+		job.thread.join();
+		for (const auto& [isError, message] : job.messages)
+		{
+			if (isError)
+			{
+				EP_ERROR("{}: {}", caller, message);
+			}
+			else
+			{
+				EP_WARN("{}: {}", caller, message);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool SceneManager::LoadEntitiesFromYAML(const std::string& yamlSrc)
+{
+	ParsedScene scene;
+	bool parsed = parseSceneYAML(yamlSrc, scene);
+
+	for (const std::string& warning : scene.warnings)
+	{
+		EP_WARN("SceneManager::LoadEntitiesFromYAML(): {}", warning);
+	}
+	if (!parsed)
+	{
+		EP_ERROR("SceneManager::LoadEntitiesFromYAML(): {}", scene.error);
+		return false;
+	}
+
+	ParsedSceneApplyState state;
+	applyParsedScene(scene, state, "SceneManager::LoadEntitiesFromYAML()", std::chrono::steady_clock::time_point::max());
+	return true;
+}
+
+bool SceneManager::LoadEntitiesFromTextFile(const std::string& path)
+{
+	std::string src;
+	if (File::LoadTextFile(path, &src) == File::ErrorCode::Success)
+	{
+		bool result = LoadEntitiesFromYAML(src);
+		if (!result)
+		{
+			EP_ERROR("SceneManager::LoadEntitiesFromTextFile(): Failure loading entities from file \"{}\".", path);
+		}
+		return result;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+
+// A text scene file being loaded across multiple frames.
+struct IncrementalSceneLoad
+{
+	std::string path;
+	std::thread parseThread;
+	std::atomic<bool> parseFinished = false;
+	bool parseSucceeded = false; // Written by parseThread before parseFinished is set
+	ParsedScene scene;
+	ParsedSceneApplyState state;
+
+	~IncrementalSceneLoad()
+	{
+		if (parseThread.joinable())
+		{
+			parseThread.join();
+		}
+	}
+};
+static std::deque<std::unique_ptr<IncrementalSceneLoad>> incrementalLoads;
+static unsigned int sceneLoadBudget = Constants::DefaultSceneLoadBudget;
+
+void SceneManager::LoadEntitiesFromTextFileAsync(const std::string& path)
+{
+	std::unique_ptr<IncrementalSceneLoad> load = std::make_unique<IncrementalSceneLoad>();
+	load->path = path;
+
+	// The worker only reads the file and parses it.  Entities are added to the scene in Update().
+	IncrementalSceneLoad* loadPtr = load.get();
+	std::string nativePath = File::VirtualPathToNative(path);
+	load->parseThread = std::thread([loadPtr, nativePath]()
+	{
+		std::ifstream stream(nativePath, std::ios_base::in | std::ios_base::binary);
+		if (stream)
+		{
+			std::stringstream src;
+			src << stream.rdbuf();
+			loadPtr->parseSucceeded = parseSceneYAML(src.str(), loadPtr->scene);
+		}
+		else
+		{
+			loadPtr->scene.error = "Could not open file.";
+		}
+		loadPtr->parseFinished.store(true, std::memory_order_release);
+	});
+
+	incrementalLoads.push_back(std::move(load));
+}
+
+void SceneManager::SetSceneLoadBudget(unsigned int microseconds)
+{
+	sceneLoadBudget = microseconds;
+}
+
+bool SceneManager::IsSceneLoading()
+{
+	return !incrementalLoads.empty();
+}
+
+float SceneManager::GetSceneLoadProgress()
+{
+	if (incrementalLoads.empty())
+		return 1.0f;
+
+	const IncrementalSceneLoad& load = *incrementalLoads.front();
+	if (!load.parseFinished.load(std::memory_order_acquire))
+		return 0.0f;
+
+	size_t totalItems = load.scene.entities.size() + load.scene.componentCount;
+	return totalItems != 0 ? float(load.state.itemsApplied) / float(totalItems) : 1.0f;
+}
+
+static void applyIncrementalLoads()
+	// Helper function: applies queued incremental loads, in order, within the per-frame time budget.
+{
+	if (incrementalLoads.empty())
+		return;
+
+	std::chrono::steady_clock::time_point deadline =
+		std::chrono::steady_clock::now() + std::chrono::microseconds(sceneLoadBudget);
+
+	while (!incrementalLoads.empty())
+	{
+		IncrementalSceneLoad& load = *incrementalLoads.front();
+		if (!load.parseFinished.load(std::memory_order_acquire))
+			return; // Still parsing: check again next frame
+
+		if (load.parseThread.joinable())
+			// First frame after parsing
+		{
+			load.parseThread.join();
+			for (const std::string& warning : load.scene.warnings)
+			{
+				EP_WARN("SceneManager::LoadEntitiesFromTextFileAsync(): {}", warning);
+			}
+
+			if (!load.parseSucceeded)
+			{
+				EP_ERROR("SceneManager::LoadEntitiesFromTextFileAsync(): Failure loading entities from file \"{}\".  "
+					"{}", load.path, load.scene.error);
+				std::string path = load.path;
+				incrementalLoads.pop_front();
+				Events::Dispatch(HN("SceneLoadFailed"), path);
+				continue;
+			}
+		}
+
+		if (!applyParsedScene(load.scene, load.state, "SceneManager::LoadEntitiesFromTextFileAsync()", deadline))
+			return; // Out of time: resume next frame
+
+		std::string path = load.path;
+		incrementalLoads.pop_front();
+		Events::Dispatch(HN("SceneLoaded"), path);
+
+		if (pastDeadline(deadline))
+			return;
+	}
+}
+
+
+static inline uint64_t appendSection(std::vector<uint8_t>& buffer, const void* data, size_t size)
+	// Helper function: appends a section to a binary scene buffer on an 8-byte boundary and returns its offset.
+{
+	buffer.resize((buffer.size() + 7) & ~size_t(7));
+	uint64_t offset = buffer.size();
+	if (size != 0)
+	{
+		buffer.insert(buffer.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+	}
+	return offset;
+}
+
+bool SceneManager::SaveEntitiesToBinaryFile(const std::string& path, const std::vector<EntityID>& entities)
+{
+	// Emit entities in ascending ID order, so that saved scenes are stable regardless of pool layout
+	std::vector<EntityID> ids;
+	if (entities.size() == 0)
+	{
+		ids.reserve(entityPool.Size());
+		for (size_t i = 0; i < entityPool.Size(); i++)
+		{
+			ids.push_back(entityPool.EntityAt(i));
+		}
+		std::sort(ids.begin(), ids.end());
+	}
+	else
+	{
+		ids.reserve(entities.size());
+		for (EntityID id : entities)
+		{
+			if (entityPool.Contains(id))
+			{
+				ids.push_back(id);
+			}
+			else
+			{
+				EP_WARN("SceneManager::SaveEntitiesToBinaryFile(): EntityID {} does not exist!", id);
+			}
+		}
+	}
+
+	// Entity table
+	std::string stringTable;
+	std::vector<HashName> names(ids.size());
+	std::vector<SceneFile::StringRef> nameStrings(ids.size());
+	std::vector<float> positions(ids.size() * 3);
+	std::vector<float> rotations(ids.size() * 4);
+	std::vector<float> scales(ids.size() * 3);
+	std::vector<EntityID> parents(ids.size());
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		size_t index = entityPool.IndexOf(ids[i]);
+		names[i] = entityPool.ValueAt(index);
+
+#ifdef EP_CONFIG_DEBUG
+		// Name strings are only known in Debug builds.  Other builds rely on the stored HashName.
+		std::string nameString = HN_ToStr(names[i]);
+		nameStrings[i] = { uint32_t(stringTable.size()), uint32_t(nameString.size()) };
+		stringTable += nameString;
+#else
+		nameStrings[i] = { 0, 0 };
+#endif
+
+		positions[i * 3] = entityPositions[index].x;
+		positions[i * 3 + 1] = entityPositions[index].y;
+		positions[i * 3 + 2] = entityPositions[index].z;
+		rotations[i * 4] = entityRotations[index].w;
+		rotations[i * 4 + 1] = entityRotations[index].x;
+		rotations[i * 4 + 2] = entityRotations[index].y;
+		rotations[i * 4 + 3] = entityRotations[index].z;
+		scales[i * 3] = entityScales[index].x;
+		scales[i * 3 + 1] = entityScales[index].y;
+		scales[i * 3 + 2] = entityScales[index].z;
+		parents[i] = entityParents[index];
+	}
+
+	SceneFile::Header header = {};
+	std::copy(std::begin(SceneFile::Magic), std::end(SceneFile::Magic), header.magic);
+	header.version = SceneFile::Version;
+	header.byteOrderMark = SceneFile::ByteOrderMark;
+
+	std::vector<uint8_t> buffer;
+	buffer.reserve(sizeof(SceneFile::Header) + ids.size() * 64);
+	buffer.resize(sizeof(SceneFile::Header));
+
+	header.entityCount = ids.size();
+	header.idsOffset = appendSection(buffer, ids.data(), ids.size() * sizeof(EntityID));
+	header.namesOffset = appendSection(buffer, names.data(), names.size() * sizeof(HashName));
+	header.nameStringsOffset = appendSection(buffer, nameStrings.data(), nameStrings.size() * sizeof(SceneFile::StringRef));
+	header.positionsOffset = appendSection(buffer, positions.data(), positions.size() * sizeof(float));
+	header.rotationsOffset = appendSection(buffer, rotations.data(), rotations.size() * sizeof(float));
+	header.scalesOffset = appendSection(buffer, scales.data(), scales.size() * sizeof(float));
+	header.parentsOffset = appendSection(buffer, parents.data(), parents.size() * sizeof(EntityID));
+
+	// Components
+	std::vector<SceneFile::ComponentTypeRecord> records;
+	std::vector<SceneFile::ComponentEntry> componentEntries;
+	std::vector<uint8_t> componentData;
+	for (const auto& [componentTypeName, tsf] : tsfs)
+	{
+		componentEntries.clear();
+		componentData.clear();
+
+		auto bsfIt = bsfs.find(componentTypeName);
+		SceneFile::ComponentEncoding encoding =
+			bsfIt != bsfs.end() ? SceneFile::ComponentEncoding::Binary : SceneFile::ComponentEncoding::YAML;
+
+		for (EntityID id : ids)
+		{
+			size_t start = componentData.size();
+			if (encoding == SceneFile::ComponentEncoding::Binary)
+			{
+				if (!bsfIt->second(id, componentData))
+				{
+					componentData.resize(start);
+					continue;
+				}
+			}
+			else
+				// No binary callbacks: embed the text serialization
+			{
+				YAML::Node callbackNode;
+				try
+				{
+					if (!tsf(id, callbackNode))
+					{
+						continue;
+					}
+				}
+				catch (const YAML::Exception& except)
+				{
+					EP_ERROR("SceneManager::SaveEntitiesToBinaryFile(): YAML exception during {} serialization!  "
+						"Message: {}", HN_ToStr(componentTypeName), except.msg);
+					continue;
+				}
+
+				YAML::Emitter componentYaml;
+				componentYaml << callbackNode;
+				componentData.insert(componentData.end(), componentYaml.c_str(), componentYaml.c_str() + componentYaml.size());
+			}
+
+			componentEntries.push_back({ id, start, componentData.size() - start });
+		}
+
+		if (componentEntries.empty())
+			continue;
+
+		SceneFile::ComponentTypeRecord record = {};
+		record.type = componentTypeName;
+#ifdef EP_CONFIG_DEBUG
+		std::string typeNameString = HN_ToStr(componentTypeName);
+		record.typeName = { uint32_t(stringTable.size()), uint32_t(typeNameString.size()) };
+		stringTable += typeNameString;
+#endif
+		record.encoding = encoding;
+		record.componentCount = componentEntries.size();
+		record.entriesOffset = appendSection(buffer,
+			componentEntries.data(), componentEntries.size() * sizeof(SceneFile::ComponentEntry));
+		record.dataOffset = appendSection(buffer, componentData.data(), componentData.size());
+		record.dataSize = componentData.size();
+		records.push_back(record);
+	}
+
+	header.componentTypeCount = records.size();
+	header.componentTypesOffset = appendSection(buffer,
+		records.data(), records.size() * sizeof(SceneFile::ComponentTypeRecord));
+	header.stringTableOffset = appendSection(buffer, stringTable.data(), stringTable.size());
+	header.stringTableSize = stringTable.size();
+	std::memcpy(buffer.data(), &header, sizeof(SceneFile::Header));
+
+	File::ErrorCode ec = File::SaveBinaryFile(path, buffer.data(), buffer.size());
+	if (ec != File::ErrorCode::Success)
+	{
+		EP_ERROR("SceneManager::SaveEntitiesToBinaryFile(): Could not save \"{}\".  Error: {}",
+			path, File::ErrorCodeToStr(ec));
+		return false;
+	}
+	return true;
+}
+
+bool SceneManager::LoadEntitiesFromBinary(const uint8_t* data, size_t size)
+{
+	if (size < sizeof(SceneFile::Header))
+	{
+		EP_ERROR("SceneManager::LoadEntitiesFromBinary(): Data is too small to contain a scene header!");
+		return false;
+	}
+	if (reinterpret_cast<uintptr_t>(data) % 8 != 0)
+	{
+		EP_ERROR("SceneManager::LoadEntitiesFromBinary(): Scene data is not 8-byte aligned!");
+		return false;
+	}
+
+	const SceneFile::Header& header = *reinterpret_cast<const SceneFile::Header*>(data);
+	if (!std::equal(std::begin(SceneFile::Magic), std::end(SceneFile::Magic), header.magic))
+	{
+		EP_ERROR("SceneManager::LoadEntitiesFromBinary(): Data is not a binary scene!");
+		return false;
+	}
+	if (header.byteOrderMark != SceneFile::ByteOrderMark)
+	{
+		EP_ERROR("SceneManager::LoadEntitiesFromBinary(): Scene was saved with a different byte order!");
+		return false;
+	}
+	if (header.version != SceneFile::Version)
+	{
+		EP_ERROR("SceneManager::LoadEntitiesFromBinary(): Unsupported scene version {} (expected {}).",
+			header.version, SceneFile::Version);
+		return false;
+	}
+
+	// Validate that every section lies within the data
+	auto sectionInBounds = [size](uint64_t offset, uint64_t count, size_t elementSize)
+	{
+		return offset % 8 == 0 && offset <= size && count <= (size - offset) / elementSize;
+	};
+	if (!sectionInBounds(header.idsOffset, header.entityCount, sizeof(EntityID)) ||
+		!sectionInBounds(header.namesOffset, header.entityCount, sizeof(HashName)) ||
+		!sectionInBounds(header.nameStringsOffset, header.entityCount, sizeof(SceneFile::StringRef)) ||
+		!sectionInBounds(header.positionsOffset, header.entityCount, sizeof(float) * 3) ||
+		!sectionInBounds(header.rotationsOffset, header.entityCount, sizeof(float) * 4) ||
+		!sectionInBounds(header.scalesOffset, header.entityCount, sizeof(float) * 3) ||
+		!sectionInBounds(header.parentsOffset, header.entityCount, sizeof(EntityID)) ||
+		!sectionInBounds(header.componentTypesOffset, header.componentTypeCount, sizeof(SceneFile::ComponentTypeRecord)) ||
+		!sectionInBounds(header.stringTableOffset, header.stringTableSize, 1))
+	{
+		EP_ERROR("SceneManager::LoadEntitiesFromBinary(): Scene data is truncated or corrupt!");
+		return false;
+	}
+
+	const EntityID* ids = reinterpret_cast<const EntityID*>(data + header.idsOffset);
+	const HashName* names = reinterpret_cast<const HashName*>(data + header.namesOffset);
+	const SceneFile::StringRef* nameStrings = reinterpret_cast<const SceneFile::StringRef*>(data + header.nameStringsOffset);
+	const float* positions = reinterpret_cast<const float*>(data + header.positionsOffset);
+	const float* rotations = reinterpret_cast<const float*>(data + header.rotationsOffset);
+	const float* scales = reinterpret_cast<const float*>(data + header.scalesOffset);
+	const EntityID* parents = reinterpret_cast<const EntityID*>(data + header.parentsOffset);
+	const char* stringTable = reinterpret_cast<const char*>(data + header.stringTableOffset);
+
+	// Entities
+	std::unordered_map<EntityID, EntityID> oldIDtoNewID;
+	oldIDtoNewID.reserve(header.entityCount);
+	for (size_t i = 0; i < header.entityCount; i++)
+	{
+		EntityID newID = prepareLoadedEntity(ids[i], "SceneManager::LoadEntitiesFromBinary()");
+		if (newID == 0)
+		{
+			continue;
+		}
+		oldIDtoNewID[ids[i]] = newID;
+
+		size_t index = entityPool.IndexOf(newID);
+		entityPool.ValueAt(index) = names[i];
+#ifdef EP_CONFIG_DEBUG
+		// Register the name string, so it can be looked up with HN_ToStr()
+		if (nameStrings[i].length != 0 &&
+			uint64_t(nameStrings[i].offset) + nameStrings[i].length <= header.stringTableSize)
+		{
+			entityPool.ValueAt(index) = HN(stringTable + nameStrings[i].offset, nameStrings[i].length);
+		}
+#endif
+		entityPositions[index] = glm::vec3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+		entityRotations[index] = glm::quat(rotations[i * 4], rotations[i * 4 + 1], rotations[i * 4 + 2], rotations[i * 4 + 3]);
+		entityScales[index] = glm::vec3(scales[i * 3], scales[i * 3 + 1], scales[i * 3 + 2]);
+		unlinkEntity(index);
+		transformChanged(index);
+	}
+
+	// Hierarchy
+	for (size_t i = 0; i < header.entityCount; i++)
+	{
+		auto idIt = oldIDtoNewID.find(ids[i]);
+		if (idIt != oldIDtoNewID.end() && parents[i] != 0 && entityPool.Contains(idIt->second))
+		{
+			auto parentIt = oldIDtoNewID.find(parents[i]);
+			setLoadedEntityParent(idIt->second, parents[i], parentIt != oldIDtoNewID.end() ? parentIt->second : 0,
+				"SceneManager::LoadEntitiesFromBinary()");
+		}
+	}
+
+	// Components
+	const SceneFile::ComponentTypeRecord* records =
+		reinterpret_cast<const SceneFile::ComponentTypeRecord*>(data + header.componentTypesOffset);
+	for (size_t t = 0; t < header.componentTypeCount; t++)
+	{
+		const SceneFile::ComponentTypeRecord& record = records[t];
+		if (!sectionInBounds(record.entriesOffset, record.componentCount, sizeof(SceneFile::ComponentEntry)) ||
+			!sectionInBounds(record.dataOffset, record.dataSize, 1))
+		{
+			EP_ERROR("SceneManager::LoadEntitiesFromBinary(): Component section {} is truncated or corrupt!  "
+				"Components will not be loaded.", t);
+			continue;
+		}
+
+		BinaryDeserializeFn bdf = nullptr;
+		TextDeserializeFn tdf = nullptr;
+		if (record.encoding == SceneFile::ComponentEncoding::Binary && bdfs.count(record.type))
+		{
+			bdf = bdfs[record.type];
+		}
+		else if (record.encoding == SceneFile::ComponentEncoding::YAML && tdfs.count(record.type))
+		{
+			tdf = tdfs[record.type];
+		}
+		else
+		{
+			EP_WARN("SceneManager::LoadEntitiesFromBinary(): \"{}\" is not a valid component type for this encoding.  "
+				"Did you register the required system using SceneManager::RegisterComponentType()?",
+				HN_ToStr(record.type));
+			continue;
+		}
+
+		const SceneFile::ComponentEntry* componentEntries =
+			reinterpret_cast<const SceneFile::ComponentEntry*>(data + record.entriesOffset);
+		const uint8_t* componentData = data + record.dataOffset;
+		for (size_t i = 0; i < record.componentCount; i++)
+		{
+			const SceneFile::ComponentEntry& entry = componentEntries[i];
+			if (entry.offset > record.dataSize || entry.size > record.dataSize - entry.offset)
+			{
+				EP_WARN("SceneManager::LoadEntitiesFromBinary(): {} component data for entity {} is out of bounds!",
+					HN_ToStr(record.type), entry.entity);
+				continue;
+			}
+
+			auto idIt = oldIDtoNewID.find(entry.entity);
+			if (idIt == oldIDtoNewID.end())
+			{
+				EP_WARN("SceneManager::LoadEntitiesFromBinary(): {} component data found for EntityID that isn't "
+					"present in the entity table!  Component will not be loaded.  EntityID: {}",
+					HN_ToStr(record.type), entry.entity);
+				continue;
+			}
+			if (!entityPool.Contains(idIt->second))
+				// Deleted by an earlier component's callbacks
+			{
+				continue;
+			}
+
+			bool success;
+			if (bdf)
+			{
+				success = bdf(idIt->second, componentData + entry.offset, entry.size);
+			}
+			else
+			{
+				try
+				{
+					success = tdf(idIt->second, YAML::Load(std::string(
+						reinterpret_cast<const char*>(componentData + entry.offset), entry.size)));
+				}
+				catch (const YAML::Exception& except)
+				{
+					EP_ERROR("SceneManager::LoadEntitiesFromBinary(): "
+						"YAML exception during {} component deserialization!  Message: {}",
+						HN_ToStr(record.type), except.msg);
+					success = false;
+				}
+			}
+
+			if (!success)
+			{
+				EP_WARN("SceneManager::LoadEntitiesFromBinary(): Could not deserialize {} component data for entity {}.",
+					HN_ToStr(record.type), entry.entity);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool SceneManager::LoadEntitiesFromBinaryFile(const std::string& path)
+{
+	File::MappedFile file(path);
+	if (file.GetLastError() != File::ErrorCode::Success)
+	{
+		return false;
+	}
+
+	bool result = LoadEntitiesFromBinary(file.Data(), file.Size());
+	if (!result)
+	{
+		EP_ERROR("SceneManager::LoadEntitiesFromBinaryFile(): Failure loading entities from file \"{}\".", path);
+	}
+	return result;
+}
+
+
+struct SceneManager::Snapshot::Data
+{
+	bool valid = false;
+	std::vector<uint8_t> entities;
+	std::vector<std::vector<uint8_t>> components; // Parallel to snapshotFns
+	// Component types without snapshot callbacks, stored as YAML text from their text serialization callbacks
+	std::vector<std::pair<HashName, std::vector<std::pair<EntityID, std::string>>>> textComponents;
+};
+
+void SceneManager::Snapshot::releaseData()
+	// Gives component types the chance to release resources retained by the snapshot.
+{
+	if (!m_data->valid)
+		return;
+
+	for (size_t i = 0; i < m_data->components.size() && i < snapshotFns.size(); i++)
+	{
+		if (snapshotFns[i].release)
+		{
+			snapshotFns[i].release(m_data->components[i].data(), m_data->components[i].size());
+		}
+	}
+	m_data->valid = false;
+}
+
+SceneManager::Snapshot::Snapshot() : m_data(std::make_unique<Data>()) {}
+
+SceneManager::Snapshot::~Snapshot()
+{
+	releaseData();
+}
+
+bool SceneManager::Snapshot::IsValid() const
+{
+	return m_data->valid;
+}
+
+size_t SceneManager::Snapshot::Size() const
+{
+	size_t returnVal = m_data->entities.size();
+	for (const std::vector<uint8_t>& componentData : m_data->components)
+	{
+		returnVal += componentData.size();
+	}
+	for (const auto& [type, components] : m_data->textComponents)
+	{
+		for (const auto& [id, text] : components)
+		{
+			returnVal += sizeof(id) + text.size();
+		}
+	}
+	return returnVal;
+}
+
+template <typename T>
+static inline void appendValue(std::vector<uint8_t>& buffer, const T& value)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static inline const uint8_t* readValue(const uint8_t* data, T& outValue)
+{
+	std::memcpy(&outValue, data, sizeof(T));
+	return data + sizeof(T);
+}
+
+template <typename T>
+static inline const uint8_t* readArray(const uint8_t* data, ChunkedArray<T>& outArray, size_t count)
+{
+	outArray.AssignBytes(data, count);
+	return data + count * sizeof(T);
+}
+
+// Scratch space for RestoreSnapshot(), kept between calls so that restoring does not allocate
+static std::vector<uint32_t> restoreGenerations;
+
+static bool hasSnapshotFns(HashName type)
+{
+	return std::any_of(snapshotFns.begin(), snapshotFns.end(),
+		[type](const SnapshotFns& fns) { return fns.type == type; });
+}
+
+bool SceneManager::TakeSnapshot(Snapshot& snapshot)
+{
+	if (IsSceneLoading())
+	{
+		EP_ERROR("SceneManager::TakeSnapshot(): Snapshots cannot be taken while a scene is loading.");
+		return false;
+	}
+
+	snapshot.releaseData();
+	Snapshot::Data& data = *snapshot.m_data;
+
+	// Entities.  World transform caches and the spatial grid are derived data, and are rebuilt on restore.
+	data.entities.clear();
+	entityPool.AppendBytes(data.entities);
+	entityPositions.AppendBytes(data.entities);
+	entityRotations.AppendBytes(data.entities);
+	entityScales.AppendBytes(data.entities);
+	entityParents.AppendBytes(data.entities);
+	entityFirstChildren.AppendBytes(data.entities);
+	entityNextSiblings.AppendBytes(data.entities);
+	entityPrevSiblings.AppendBytes(data.entities);
+
+	appendValue(data.entities, nextUnusedSpawnedIndex);
+	spawnedGenerations.AppendBytes(data.entities); // nextUnusedSpawnedIndex - 1 elements
+	appendValue(data.entities, uint64_t(availableSpawnedIndices.size()));
+	const uint8_t* availableBytes = reinterpret_cast<const uint8_t*>(availableSpawnedIndices.data());
+	data.entities.insert(data.entities.end(),
+		availableBytes, availableBytes + availableSpawnedIndices.size() * sizeof(uint32_t));
+
+	// Components
+	data.components.resize(snapshotFns.size());
+	for (size_t i = 0; i < snapshotFns.size(); i++)
+	{
+		data.components[i].clear();
+		snapshotFns[i].save(data.components[i]);
+	}
+
+	data.textComponents.clear();
+	for (const auto& [componentTypeName, tsf] : tsfs)
+	{
+		if (hasSnapshotFns(componentTypeName))
+			continue;
+
+		auto& [type, components] = data.textComponents.emplace_back();
+		type = componentTypeName;
+		for (EntityID id : qcfs[componentTypeName]())
+		{
+			YAML::Node callbackNode;
+			try
+			{
+				if (tsf(id, callbackNode))
+				{
+					YAML::Emitter componentYaml;
+					componentYaml << callbackNode;
+					components.emplace_back(id, std::string(componentYaml.c_str(), componentYaml.size()));
+				}
+			}
+			catch (const YAML::Exception& except)
+			{
+				EP_ERROR("SceneManager::TakeSnapshot(): YAML exception during {} serialization!  Message: {}",
+					HN_ToStr(componentTypeName), except.msg);
+			}
+		}
+	}
+
+	data.valid = true;
+	return true;
+}
+
+bool SceneManager::RestoreSnapshot(const Snapshot& snapshot)
+{
+	if (IsSceneLoading())
+	{
+		EP_ERROR("SceneManager::RestoreSnapshot(): Snapshots cannot be restored while a scene is loading.");
+		return false;
+	}
+	const Snapshot::Data& data = *snapshot.m_data;
+	if (!data.valid)
+	{
+		EP_ERROR("SceneManager::RestoreSnapshot(): Snapshot is empty!");
+		return false;
+	}
+
+	// Text-serialized component types are removed while the entities that own them still exist
+	for (const auto& [componentTypeName, components] : data.textComponents)
+	{
+		DelComponentFn dcf = dcfs[dcfIndices[componentTypeName]];
+		for (EntityID id : qcfs[componentTypeName]())
+		{
+			dcf(id);
+		}
+	}
+
+	// Entities.  First, note the generation each spawned slot would hand out next, so that IDs issued since the
+	// snapshot was taken stay stale once it is restored.  Slots in use have already handed out their generation.
+	restoreGenerations.resize(nextUnusedSpawnedIndex - 1);
+	for (uint32_t index = 1; index < nextUnusedSpawnedIndex; index++)
+	{
+		uint32_t generation = spawnedGenerations[index - 1];
+		bool inUse = entityPool.Contains(EntityID_Make(index, generation));
+		restoreGenerations[index - 1] = inUse ? nextSpawnedGeneration(generation) : generation;
+	}
+
+	const uint8_t* cursor = entityPool.AssignBytes(data.entities.data());
+	size_t count = entityPool.Size();
+	cursor = readArray(cursor, entityPositions, count);
+	cursor = readArray(cursor, entityRotations, count);
+	cursor = readArray(cursor, entityScales, count);
+	while (entityPrevPositions.Size() > count)
+	{
+		entityPrevPositions.PopBack();
+		entityPrevRotations.PopBack();
+	}
+	while (entityPrevPositions.Size() < count)
+	{
+		entityPrevPositions.PushBack(glm::vec3());
+		entityPrevRotations.PushBack(glm::quat());
+	}
+	capturePreviousTransforms(); // Restores are teleports
+	cursor = readArray(cursor, entityParents, count);
+	cursor = readArray(cursor, entityFirstChildren, count);
+	cursor = readArray(cursor, entityNextSiblings, count);
+	cursor = readArray(cursor, entityPrevSiblings, count);
+
+	cursor = readValue(cursor, nextUnusedSpawnedIndex);
+	cursor = readArray(cursor, spawnedGenerations, nextUnusedSpawnedIndex - 1);
+	uint64_t availableCount;
+	cursor = readValue(cursor, availableCount);
+	availableSpawnedIndices.resize(size_t(availableCount));
+	std::memcpy(availableSpawnedIndices.data(), cursor, size_t(availableCount) * sizeof(uint32_t));
+
+	// Generations never move backwards.  Slots first used after the snapshot was taken are free in the restored scene.
+	for (uint32_t index = 1; index <= restoreGenerations.size(); index++)
+	{
+		if (index < nextUnusedSpawnedIndex)
+		{
+			spawnedGenerations[index - 1] = std::max(spawnedGenerations[index - 1], restoreGenerations[index - 1]);
+		}
+		else
+		{
+			spawnedGenerations.PushBack(restoreGenerations[index - 1]);
+			availableSpawnedIndices.push_back(index);
+		}
+	}
+	nextUnusedSpawnedIndex = std::max(nextUnusedSpawnedIndex, uint32_t(restoreGenerations.size() + 1));
+
+	while (entityWorldSlots.Size() > count)
+	{
+		entityWorldSlots.PopBack();
+	}
+	while (entityWorldSlots.Size() < count)
+	{
+		entityWorldSlots.PushBack(0);
+	}
+	entityGridLocations.Clear();
+	for (size_t i = 0; i < count; i++)
+	{
+		entityGridLocations.PushBack({ NoGridCell, 0, nullptr });
+	}
+	gridCells.clear();
+	worldOrderDirty = true;
+
+	// Components
+	for (size_t i = 0; i < data.components.size() && i < snapshotFns.size(); i++)
+	{
+		snapshotFns[i].restore(data.components[i].data(), data.components[i].size());
+	}
+	for (const auto& [componentTypeName, components] : data.textComponents)
+	{
+		TextDeserializeFn tdf = tdfs[componentTypeName];
+		for (const auto& [id, componentData] : components)
+		{
+			try
+			{
+				if (!tdf(id, YAML::Load(componentData)))
+				{
+					EP_WARN("SceneManager::RestoreSnapshot(): Could not restore {} component data for entity {}.",
+						HN_ToStr(componentTypeName), id);
+				}
+			}
+			catch (const YAML::Exception& except)
+			{
+				EP_ERROR("SceneManager::RestoreSnapshot(): YAML exception during {} component deserialization!  "
+					"Message: {}", HN_ToStr(componentTypeName), except.msg);
+			}
+		}
+	}
+
+	Events::Dispatch(HN("SceneRestored"));
+	return true;
+}
+
+
+static void deleteAllEntities()
+	// Helper function: removes every entity from the scene.
+{
+	while (entityPool.Size() != 0)
+	{
+		SceneManager::DeleteEntity(entityPool.EntityAt(entityPool.Size() - 1));
+	}
+}
+
+bool SceneManager::ConvertTextSceneToBinary(const std::string& srcPath, const std::string& dstPath)
+{
+	if (entityPool.Size() != 0)
+	{
+		EP_ERROR("SceneManager::ConvertTextSceneToBinary(): Scenes can only be converted while no entities exist.");
+		return false;
+	}
+
+	bool result = LoadEntitiesFromTextFile(srcPath) && SaveEntitiesToBinaryFile(dstPath);
+	deleteAllEntities();
+	return result;
+}
+
+bool SceneManager::ConvertBinarySceneToText(const std::string& srcPath, const std::string& dstPath)
+{
+	if (entityPool.Size() != 0)
+	{
+		EP_ERROR("SceneManager::ConvertBinarySceneToText(): Scenes can only be converted while no entities exist.");
+		return false;
+	}
+
+	bool result = LoadEntitiesFromBinaryFile(srcPath);
+	if (result)
+	{
+		SaveEntitiesToTextFile(dstPath);
+	}
+	deleteAllEntities();
+	return result;
+}
+
+
+struct SystemTiming
+{
+	std::string name;
+	const char* phase;
+	uint64_t invocations = 0;
+	std::vector<float> samples; // Ring buffer of recent invocation times, in milliseconds
+	size_t nextSample = 0;
+};
+// A deque, so that timings stay in place while other threads record into them
+static std::deque<SystemTiming> systemTimings;
+#ifdef EP_CONFIG_RELEASE
+static bool systemTimingEnabled = false;
+#else
+static bool systemTimingEnabled = true;
+#endif
+static std::string systemTimingDumpPath;
+static unsigned int systemTimingDumpInterval = Constants::DefaultSystemTimingDumpInterval;
+static unsigned int framesSinceTimingDump = 0;
+
+static const char* const systemPhaseNames[] = { "FixedUpdate", "Update", "PreDraw", "SceneDraw" };
+static constexpr size_t SceneDrawPhaseIndex = 3;
+
+static size_t addSystemTiming(size_t phaseIndex, const std::string& name)
+	// Helper function: creates the timing record of a new system.
+{
+	size_t phaseCount = 0;
+	for (const SystemTiming& timing : systemTimings)
+	{
+		if (timing.phase == systemPhaseNames[phaseIndex])
+		{
+			phaseCount++;
+		}
+	}
+
+	SystemTiming& timing = systemTimings.emplace_back();
+	timing.name = name.empty() ? std::string(systemPhaseNames[phaseIndex]) + " #" + std::to_string(phaseCount) : name;
+	timing.phase = systemPhaseNames[phaseIndex];
+	timing.samples.reserve(Constants::SystemTimingWindow);
+	return systemTimings.size() - 1;
+}
+
+static inline void invokeSystem(SceneManager::CoreCallFn fn, size_t timingIndex)
+	// Helper function: runs a system, recording its CPU time if timing is enabled.
+{
+	if (!systemTimingEnabled)
+	{
+		fn();
+		return;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	fn();
+	auto end = std::chrono::steady_clock::now();
+
+	// Each system runs on one thread at a time, so its record needs no lock
+	SystemTiming& timing = systemTimings[timingIndex];
+	float ms = std::chrono::duration<float, std::milli>(end - start).count();
+	if (timing.samples.size() < Constants::SystemTimingWindow)
+	{
+		timing.samples.push_back(ms);
+	}
+	else
+	{
+		timing.samples[timing.nextSample] = ms;
+	}
+	timing.nextSample = (timing.nextSample + 1) % Constants::SystemTimingWindow;
+	timing.invocations++;
+}
+
+struct System
+{
+	SceneManager::CoreCallFn fn;
+	size_t timing; // Index into systemTimings
+	std::vector<HashName> reads; // Sorted
+	std::vector<HashName> writes; // Sorted
+	bool exclusive; // Conflicts with every other system in the phase
+	bool mainThreadOnly;
+};
+struct SystemGraph
+{
+	std::vector<System> systems; // In registration order
+	std::vector<std::vector<size_t>> dependents;
+	std::vector<size_t> dependencyCounts;
+	bool sequential = true; // Every system depends on the one before it
+	bool dirty = false;
+};
+static std::array<SystemGraph, 3> systemGraphs; // Indexed by SystemPhase
+
+struct DrawCallback
+{
+	SceneManager::CoreCallFn fn;
+	size_t timing;
+};
+static std::vector<DrawCallback> drawCallbacks;
+
+static bool parallelSystems = true;
+static unsigned int systemWorkerThreads = 0;
+static std::vector<std::thread> systemWorkers;
+static bool stopSystemWorkers = false;
+
+// Scheduler state, guarded by schedulerMutex
+static std::mutex schedulerMutex;
+static std::condition_variable workerCondition; // Signalled when a worker system becomes ready
+static std::condition_variable mainCondition; // Signalled when any system becomes ready, or the phase completes
+static const SystemGraph* activeGraph = nullptr;
+static std::vector<size_t> remainingDependencies;
+static size_t systemsRemaining = 0;
+static std::deque<size_t> readyWorkerSystems;
+static std::deque<size_t> readyMainSystems;
+
+static bool sortedRangesIntersect(const std::vector<HashName>& a, const std::vector<HashName>& b)
+	// Helper function: checks whether two sorted vectors share an element.
+{
+	auto ia = a.begin(), ib = b.begin();
+	while (ia != a.end() && ib != b.end())
+	{
+		if (*ia < *ib) ia++;
+		else if (*ib < *ia) ib++;
+		else return true;
+	}
+	return false;
+}
+
+static bool systemsConflict(const System& a, const System& b)
+	// Helper function: checks whether two systems must not run at the same time.
+{
+	// Main thread systems are kept in registration order too, as they exist to touch shared engine state
+	return a.exclusive || b.exclusive || (a.mainThreadOnly && b.mainThreadOnly) ||
+		sortedRangesIntersect(a.writes, b.writes) ||
+		sortedRangesIntersect(a.writes, b.reads) ||
+		sortedRangesIntersect(a.reads, b.writes);
+}
+
+static void buildSystemGraph(SystemGraph& graph)
+	// Helper function: links each system to the earlier systems it conflicts with.
+{
+	size_t count = graph.systems.size();
+	graph.dependents.assign(count, {});
+	graph.dependencyCounts.assign(count, 0);
+	graph.sequential = true;
+
+	// Edges only point forward, so registration order is always a valid execution order
+	for (size_t later = 1; later < count; later++)
+	{
+		for (size_t earlier = 0; earlier < later; earlier++)
+		{
+			if (systemsConflict(graph.systems[earlier], graph.systems[later]))
+			{
+				graph.dependents[earlier].push_back(later);
+				graph.dependencyCounts[later]++;
+			}
+			else if (earlier == later - 1)
+			{
+				graph.sequential = false;
+			}
+		}
+	}
+
+	graph.dirty = false;
+}
+
+static void registerSystem(SceneManager::SystemPhase phase, System&& system, const std::string& name)
+	// Helper function: adds a system to a phase's graph.
+{
+	EP_ASSERT(system.fn);
+	EP_ASSERTF(activeGraph == nullptr, "SceneManager: Systems cannot be registered while systems are running.");
+	system.timing = addSystemTiming(size_t(phase), name);
+
+	for (std::vector<HashName>* set : { &system.reads, &system.writes })
+	{
+		std::sort(set->begin(), set->end());
+		set->erase(std::unique(set->begin(), set->end()), set->end());
+	}
+
+	SystemGraph& graph = systemGraphs[size_t(phase)];
+	graph.systems.push_back(std::move(system));
+	graph.dirty = true;
+}
+
+static void enqueueSystem(size_t system)
+	// Helper function: hands a ready system to the thread that will run it.  Requires schedulerMutex.
+{
+	if (activeGraph->systems[system].mainThreadOnly)
+	{
+		readyMainSystems.push_back(system);
+	}
+	else
+	{
+		readyWorkerSystems.push_back(system);
+		workerCondition.notify_one();
+	}
+	mainCondition.notify_one(); // The main thread runs worker systems too while it waits
+}
+
+static void finishSystem(size_t system)
+	// Helper function: releases the dependents of a completed system.  Requires schedulerMutex.
+{
+	for (size_t dependent : activeGraph->dependents[system])
+	{
+		if (--remainingDependencies[dependent] == 0)
+		{
+			enqueueSystem(dependent);
+		}
+	}
+
+	systemsRemaining--;
+	if (systemsRemaining == 0)
+	{
+		mainCondition.notify_one();
+	}
+}
+
+static void systemWorkerLoop()
+	// Helper function: the body of each system worker thread.
+{
+	std::unique_lock<std::mutex> lock(schedulerMutex);
+	while (true)
+	{
+		workerCondition.wait(lock, []() { return stopSystemWorkers || !readyWorkerSystems.empty(); });
+		if (stopSystemWorkers)
+			return;
+
+		size_t system = readyWorkerSystems.front();
+		readyWorkerSystems.pop_front();
+
+		lock.unlock();
+		invokeSystem(activeGraph->systems[system].fn, activeGraph->systems[system].timing);
+		lock.lock();
+
+		finishSystem(system);
+	}
+}
+
+static void stopSystemWorkerThreads()
+	// Helper function: joins every system worker thread.
+{
+	{
+		std::lock_guard<std::mutex> lock(schedulerMutex);
+		stopSystemWorkers = true;
+	}
+	workerCondition.notify_all();
+	for (std::thread& worker : systemWorkers)
+	{
+		worker.join();
+	}
+	systemWorkers.clear();
+	stopSystemWorkers = false;
+}
+
+static void runSystems(SceneManager::SystemPhase phase)
+	// Helper function: runs every system registered to a phase, concurrently where their access sets allow.
+{
+	SystemGraph& graph = systemGraphs[size_t(phase)];
+	if (graph.dirty)
+	{
+		buildSystemGraph(graph);
+	}
+
+	if (!parallelSystems || graph.sequential || systemWorkerThreads == 0)
+	{
+		for (const System& system : graph.systems)
+		{
+			invokeSystem(system.fn, system.timing);
+		}
+		return;
+	}
+
+	if (systemWorkers.empty())
+	{
+		for (unsigned int i = 0; i < systemWorkerThreads; i++)
+		{
+			systemWorkers.emplace_back(systemWorkerLoop);
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(schedulerMutex);
+	activeGraph = &graph;
+	remainingDependencies = graph.dependencyCounts;
+	systemsRemaining = graph.systems.size();
+	for (size_t i = 0; i < graph.systems.size(); i++)
+	{
+		if (remainingDependencies[i] == 0)
+		{
+			enqueueSystem(i);
+		}
+	}
+
+	while (systemsRemaining != 0)
+	{
+		mainCondition.wait(lock, []()
+			{ return systemsRemaining == 0 || !readyMainSystems.empty() || !readyWorkerSystems.empty(); });
+		if (systemsRemaining == 0)
+			break;
+
+		std::deque<size_t>& queue = readyMainSystems.empty() ? readyWorkerSystems : readyMainSystems;
+		size_t system = queue.front();
+		queue.pop_front();
+
+		lock.unlock();
+		invokeSystem(graph.systems[system].fn, graph.systems[system].timing);
+		lock.lock();
+
+		finishSystem(system);
+	}
+	activeGraph = nullptr;
+}
+
+void SceneManager::RegisterFixedUpdateFn(CoreCallFn func, const std::string& name)
+{
+	registerSystem(SystemPhase::FixedUpdate, { func, 0, {}, {}, true, true }, name);
+}
+
+void SceneManager::RegisterUpdateFn(CoreCallFn func, const std::string& name)
+{
+	registerSystem(SystemPhase::Update, { func, 0, {}, {}, true, true }, name);
+}
+
+void SceneManager::RegisterPreDrawFn(CoreCallFn func, const std::string& name)
+{
+	registerSystem(SystemPhase::PreDraw, { func, 0, {}, {}, true, true }, name);
+}
+
+void SceneManager::RegisterSystem(SystemPhase phase, CoreCallFn func,
+	const std::vector<HashName>& reads, const std::vector<HashName>& writes, bool mainThreadOnly,
+	const std::string& name)
+{
+	registerSystem(phase, { func, 0, reads, writes, false, mainThreadOnly }, name);
+}
+
+void SceneManager::SetParallelSystems(bool enabled)
+{
+	parallelSystems = enabled;
+}
+
+void SceneManager::RegisterSceneDrawFn(CoreCallFn func, const std::string& name)
+{
+	EP_ASSERT(func);
+	drawCallbacks.push_back({ func, addSystemTiming(SceneDrawPhaseIndex, name) });
+}
+
+
+void SceneManager::DrawScene()
+{
+	for (const DrawCallback& c : drawCallbacks)
+	{
+		invokeSystem(c.fn, c.timing);
+	}
+}
+
+
+std::vector<SceneManager::SystemTimingStats> SceneManager::GetSystemTimingStats()
+{
+	std::vector<SystemTimingStats> returnVal;
+	returnVal.reserve(systemTimings.size());
+
+	std::vector<float> sorted;
+	for (const SystemTiming& timing : systemTimings)
+	{
+		SystemTimingStats& stats = returnVal.emplace_back();
+		stats.name = timing.name;
+		stats.phase = timing.phase;
+		stats.invocations = timing.invocations;
+		stats.sampleCount = timing.samples.size();
+		stats.minMs = stats.avgMs = stats.maxMs = stats.p99Ms = 0.0;
+		if (timing.samples.empty())
+			continue;
+
+		sorted = timing.samples;
+		std::sort(sorted.begin(), sorted.end());
+		double total = 0.0;
+		for (float sample : sorted)
+		{
+			total += sample;
+		}
+		stats.minMs = sorted.front();
+		stats.maxMs = sorted.back();
+		stats.avgMs = total / sorted.size();
+		stats.p99Ms = sorted[(sorted.size() * 99 + 99) / 100 - 1]; // Nearest rank
+	}
+
+	return returnVal;
+}
+
+void SceneManager::ResetSystemTimingStats()
+{
+	EP_ASSERTF(activeGraph == nullptr, "SceneManager: Timings cannot be reset while systems are running.");
+	for (SystemTiming& timing : systemTimings)
+	{
+		timing.invocations = 0;
+		timing.samples.clear();
+		timing.nextSample = 0;
+	}
+}
+
+static std::string escapeJSONString(const std::string& str)
+	// Helper function: escapes a string for a JSON string literal.  Control characters become spaces.
+{
+	std::string returnVal;
+	returnVal.reserve(str.size());
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+		{
+			returnVal += '\\';
+			returnVal += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			returnVal += ' ';
+		}
+		else
+		{
+			returnVal += c;
+		}
+	}
+	return returnVal;
+}
+
+static std::string escapeCSVField(const std::string& str)
+	// Helper function: quotes a CSV field if it contains separators or quotes.
+{
+	if (str.find_first_of(",\"\n") == std::string::npos)
+		return str;
+
+	std::string returnVal = "\"";
+	for (char c : str)
+	{
+		if (c == '"')
+		{
+			returnVal += '"';
+		}
+		returnVal += c;
+	}
+	returnVal += '"';
+	return returnVal;
+}
+
+bool SceneManager::DumpSystemTimingStats(const std::string& path)
+{
+	std::vector<SystemTimingStats> stats = GetSystemTimingStats();
+	std::ostringstream out;
+
+	bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+	if (json)
+	{
+		out << "[\n";
+		for (size_t i = 0; i < stats.size(); i++)
+		{
+			const SystemTimingStats& s = stats[i];
+			out << "\t{ \"name\": \"" << escapeJSONString(s.name) << "\", \"phase\": \"" << s.phase
+				<< "\", \"invocations\": " << s.invocations << ", \"samples\": " << s.sampleCount
+				<< ", \"minMs\": " << s.minMs << ", \"avgMs\": " << s.avgMs
+				<< ", \"maxMs\": " << s.maxMs << ", \"p99Ms\": " << s.p99Ms
+				<< (i + 1 < stats.size() ? " },\n" : " }\n");
+		}
+		out << "]\n";
+	}
+	else
+	{
+		out << "name,phase,invocations,samples,minMs,avgMs,maxMs,p99Ms\n";
+		for (const SystemTimingStats& s : stats)
+		{
+			out << escapeCSVField(s.name) << ',' << s.phase << ',' << s.invocations << ',' << s.sampleCount << ','
+				<< s.minMs << ',' << s.avgMs << ',' << s.maxMs << ',' << s.p99Ms << '\n';
+		}
+	}
+
+	if (File::SaveTextFile(path, out.str()) != File::ErrorCode::Success)
+	{
+		EP_ERROR("SceneManager::DumpSystemTimingStats(): Could not write \"{}\".", path);
+		return false;
+	}
+	return true;
+}
+
+void SceneManager::SetSystemTimingEnabled(bool enabled)
+{
+	EP_ASSERTF(activeGraph == nullptr, "SceneManager: Timing cannot be toggled while systems are running.");
+	systemTimingEnabled = enabled;
+}
+
+
+void SceneManager::Init()
+{
+	size_t entityCapacity = Constants::DefaultEntityCapacity;
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	systemWorkerThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+
+	// Projects can override pool sizes in the "SceneManager" section of the project file
+	if (Runtime::CheckCmdLineOption(HN("--project")))
+	{
+		std::vector<std::string> projectOptionArgs = Runtime::GetCmdLineOption(HN("--project"));
+		std::string projectFileContents;
+
+		if (projectOptionArgs.size() &&
+			File::LoadTextFile(projectOptionArgs.front(), &projectFileContents) == File::ErrorCode::Success)
+		{
+			try
+			{
+				YAML::Node yamlIn = YAML::Load(projectFileContents);
+				if (yamlIn.Type() == YAML::NodeType::Map && yamlIn["SceneManager"])
+				{
+					if (yamlIn["SceneManager"]["EntityCapacity"])
+					{
+						entityCapacity = yamlIn["SceneManager"]["EntityCapacity"].as<size_t>();
+					}
+					if (yamlIn["SceneManager"]["SpawnedIDRange"])
+					{
+						spawnedIDRange = yamlIn["SceneManager"]["SpawnedIDRange"].as<size_t>();
+					}
+					if (yamlIn["SceneManager"]["SceneLoadBudget"])
+					{
+						sceneLoadBudget = yamlIn["SceneManager"]["SceneLoadBudget"].as<unsigned int>();
+					}
+					if (yamlIn["SceneManager"]["ParallelDeserialization"])
+					{
+						parallelDeserialization = yamlIn["SceneManager"]["ParallelDeserialization"].as<bool>();
+					}
+					if (yamlIn["SceneManager"]["SpatialCellSize"])
+					{
+						gridCellSize = yamlIn["SceneManager"]["SpatialCellSize"].as<float>();
+					}
+					if (yamlIn["SceneManager"]["ParallelSystems"])
+					{
+						parallelSystems = yamlIn["SceneManager"]["ParallelSystems"].as<bool>();
+					}
+					if (yamlIn["SceneManager"]["SystemWorkerThreads"])
+					{
+						systemWorkerThreads = yamlIn["SceneManager"]["SystemWorkerThreads"].as<unsigned int>();
+					}
+					if (yamlIn["SceneManager"]["SystemTiming"])
+					{
+						systemTimingEnabled = yamlIn["SceneManager"]["SystemTiming"].as<bool>();
+					}
+					if (yamlIn["SceneManager"]["SystemTimingDumpPath"])
+					{
+						systemTimingDumpPath = yamlIn["SceneManager"]["SystemTimingDumpPath"].as<std::string>();
+					}
+					if (yamlIn["SceneManager"]["SystemTimingDumpInterval"])
+					{
+						systemTimingDumpInterval =
+							yamlIn["SceneManager"]["SystemTimingDumpInterval"].as<unsigned int>();
+					}
+				}
+			}
+			catch (const YAML::Exception& e)
+			{
+				EP_ERROR("SceneManager::Init(): YAML exception while reading project file!  Default pool sizes will "
+					"be used.  Message: {}", e.msg);
+				entityCapacity = Constants::DefaultEntityCapacity;
+				spawnedIDRange = Constants::DefaultSpawnedIDRange;
+				sceneLoadBudget = Constants::DefaultSceneLoadBudget;
+				gridCellSize = Constants::DefaultSpatialCellSize;
+			}
+		}
+	}
+
+	if (spawnedIDRange == 0 || spawnedIDRange > UINT32_MAX)
+	{
+		EP_ERROR("SceneManager::Init(): \"SpawnedIDRange\" must be in [1, {}].  Default will be used.", UINT32_MAX);
+		spawnedIDRange = Constants::DefaultSpawnedIDRange;
+	}
+	if (!(gridCellSize > 0.0f) || !std::isfinite(gridCellSize))
+	{
+		EP_ERROR("SceneManager::Init(): \"SpatialCellSize\" must be a positive number.  Default will be used.");
+		gridCellSize = Constants::DefaultSpatialCellSize;
+	}
+
+	// Pools grow in chunks past these sizes if needed
+	entityPool.Reserve(entityCapacity);
+	entityPositions.Reserve(entityCapacity);
+	entityRotations.Reserve(entityCapacity);
+	entityScales.Reserve(entityCapacity);
+	entityPrevPositions.Reserve(entityCapacity);
+	entityPrevRotations.Reserve(entityCapacity);
+	entityParents.Reserve(entityCapacity);
+	entityFirstChildren.Reserve(entityCapacity);
+	entityNextSiblings.Reserve(entityCapacity);
+	entityPrevSiblings.Reserve(entityCapacity);
+	entityWorldSlots.Reserve(entityCapacity);
+	entityGridLocations.Reserve(entityCapacity);
+	availableSpawnedIndices.reserve(std::min(entityCapacity, spawnedIDRange));
+}
+
+void SceneManager::Cleanup()
+{
+	stopSystemWorkerThreads();
+}
+
+void SceneManager::FixedUpdate()
+{
+	capturePreviousTransforms();
+
+	inFixedUpdate = true;
+	runSystems(SystemPhase::FixedUpdate);
+	inFixedUpdate = false;
+}
+
+void SceneManager::Update()
+{
+	// Removal logs only need to reach back as far as the oldest tracked frame
+	frameStartTicks[frameCount % Constants::ChangeHistoryFrames] = CaptureChangeTick();
+	frameCount++;
+	uint32_t oldestTick = GetOldestTrackedTick();
+	entityPool.TrimRemovals(oldestTick);
+	for (const auto& [type, pool] : componentPools)
+	{
+		pool->TrimRemovals(oldestTick);
+	}
+
+	applyIncrementalLoads();
+
+	runSystems(SystemPhase::Update);
+
+	if (!systemTimingDumpPath.empty() && ++framesSinceTimingDump >= systemTimingDumpInterval)
+	{
+		framesSinceTimingDump = 0;
+		DumpSystemTimingStats(systemTimingDumpPath);
+	}
+}
+
+void SceneManager::PreDraw()
+{
+	updateInterpolatedWorldTransforms();
+
+	runSystems(SystemPhase::PreDraw);
 }
 
 }
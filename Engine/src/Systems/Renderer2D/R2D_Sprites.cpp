@@ -2,18 +2,23 @@
 
 using namespace Enterprise;
 
-std::vector<Renderer2D::SpriteComponent> Renderer2D::spriteComponents;
-std::vector<TextureFilter> Renderer2D::minFilters;
+SparseSet<Renderer2D::SpriteComponent> Renderer2D::spriteComponents;
+size_t Renderer2D::maxSpriteComponents = 0;
+std::vector<TextureFilter> Renderer2D::minFilters; // Parallel to spriteComponents' dense array
 std::vector<TextureFilter> Renderer2D::magFilters;
 std::vector<MipmapMode> Renderer2D::mipModes;
-static size_t spriteComponentCount = 0;
-static std::map<EntityID, size_t> spriteComponentIndices;
+
+// Scratch buffer for fetching sprite world transforms in bulk
+static std::vector<glm::mat4> spriteTransformScratch;
 
 static Graphics::TextureHandle samplerSlots[16];
 static size_t numOfAssignedSamplerSlots = 0;
 static size_t spritesToPush = 0;
 static bool inBatch = false;
 
+HN_CONSTANT(batchedTexturesOption, "BATCHED_TEXTURES");
+HN_CONSTANT(batchedTexturesUniform, "btex_textures");
+
 void Renderer2D::BeginBatch()
 {
 	if (inBatch)
@@ -25,13 +30,24 @@ void Renderer2D::BeginBatch()
 	numOfAssignedSamplerSlots = 0;
 	spritesToPush = 0;
 	Graphics::SetModelMatrix(glm::mat4(1.0f));
-	Graphics::EnableShaderOption(HN("BATCHED_TEXTURES"), true);
+	Graphics::EnableShaderOption(batchedTexturesOption, true);
 	inBatch = true;
 }
 
 void Renderer2D::DrawSprite(Graphics::TextureHandle texture,
 	float uv_l, float uv_r, float uv_b, float uv_t,
 	glm::vec3 position, glm::quat rotation, glm::vec2 scale)
+{
+	glm::mat4 modelmat = glm::translate(glm::mat4(1.0f), position);
+	modelmat *= glm::mat4_cast(rotation);
+	modelmat = glm::scale(modelmat, glm::vec3(scale, 1));
+
+	DrawSprite(texture, uv_l, uv_r, uv_b, uv_t, modelmat);
+}
+
+void Renderer2D::DrawSprite(Graphics::TextureHandle texture,
+	float uv_l, float uv_r, float uv_b, float uv_t,
+	const glm::mat4& modelmat)
 {
 	if (!inBatch)
 	{
@@ -62,7 +78,7 @@ void Renderer2D::DrawSprite(Graphics::TextureHandle texture,
 			i = 0;
 		}
 
-		Graphics::BindTexture(texture, HN("btex_textures"), i);
+		Graphics::BindTexture(texture, batchedTexturesUniform, i);
 		samplerSlots[i] = texture;
 
 		quadVertices[i * 4].in_tex = i;
@@ -73,11 +89,6 @@ void Renderer2D::DrawSprite(Graphics::TextureHandle texture,
 		numOfAssignedSamplerSlots++;
 	}
 
-
-	glm::mat4 modelmat = glm::translate(glm::mat4(1.0f), position);
-	modelmat *= glm::mat4_cast(rotation);
-	modelmat = glm::scale(modelmat, glm::vec3(scale, 1));
-
 	quadVertices[spritesToPush * 4].ep_position = glm::vec3(modelmat * glm::vec4(-0.5f, -0.5f, 0.0f, 1.0f));
 	quadVertices[spritesToPush * 4 + 1].ep_position = glm::vec3(modelmat * glm::vec4(0.5f, -0.5f, 0.0f, 1.0f));
 	quadVertices[spritesToPush * 4 + 2].ep_position = glm::vec3(modelmat * glm::vec4(0.5f, 0.5f, 0.0f, 1.0f));
@@ -89,7 +100,7 @@ void Renderer2D::DrawSprite(Graphics::TextureHandle texture,
 	quadVertices[spritesToPush * 4 + 3].in_uv = glm::vec2(uv_l, uv_t);
 
 	spritesToPush++;
-	if (spritesToPush >= spriteComponents.size())
+	if (spritesToPush >= maxSpriteComponents)
 	{
 		EndBatch();
 		BeginBatch();
@@ -106,27 +117,39 @@ void Renderer2D::EndBatch()
 
 	Graphics::SetVertexData(quadVAH, quadVertices.data(), 0, spritesToPush * 4);
 	Graphics::DrawTriangles(quadVAH, spritesToPush * 6, 0);
-	Graphics::DisableShaderOption(HN("BATCHED_TEXTURES"));
+	Graphics::DisableShaderOption(batchedTexturesOption);
 	inBatch = false;
 }
 
 void Renderer2D::DrawSpriteComponents()
 {
+	if (spriteTransformScratch.size() < ChunkedArray<EntityID>::ElementsPerChunk)
+	{
+		spriteTransformScratch.resize(ChunkedArray<EntityID>::ElementsPerChunk);
+	}
+
 	BeginBatch();
 
-	for (size_t i = 0; i < spriteComponentCount; i++)
+	// Sprite pool storage is contiguous per chunk, so interpolated world transforms are fetched one chunk at a time
+	const ChunkedArray<EntityID>& entities = spriteComponents.Entities();
+	const ChunkedArray<SpriteComponent>& sprites = spriteComponents.Values();
+	for (size_t chunk = 0; chunk < entities.ChunkCount(); chunk++)
 	{
-		DrawSprite(spriteComponents[i].tex,
-			spriteComponents[i].uv_bounds[0],
-			spriteComponents[i].uv_bounds[1],
-			spriteComponents[i].uv_bounds[2],
-			spriteComponents[i].uv_bounds[3],
-			SceneManager::GetEntityPosition(spriteComponents[i].id),
-			SceneManager::GetEntityRotation(spriteComponents[i].id),
-			{
-				SceneManager::GetEntityScale(spriteComponents[i].id).x,
-				SceneManager::GetEntityScale(spriteComponents[i].id).y
-			});
+		size_t count = entities.ChunkLength(chunk);
+		const SpriteComponent* chunkSprites = sprites.ChunkData(chunk);
+
+		SceneManager::GetEntityInterpolatedWorldMatrices(entities.ChunkData(chunk), count,
+			spriteTransformScratch.data());
+
+		for (size_t i = 0; i < count; i++)
+		{
+			DrawSprite(chunkSprites[i].tex,
+				chunkSprites[i].uv_bounds[0],
+				chunkSprites[i].uv_bounds[1],
+				chunkSprites[i].uv_bounds[2],
+				chunkSprites[i].uv_bounds[3],
+				spriteTransformScratch[i]);
+		}
 	}
 
 	EndBatch();
@@ -204,40 +227,68 @@ static inline const char* mipModeToStr(MipmapMode mode)
 
 void Renderer2D::DeleteSpriteComponent(EntityID entity)
 {
-	Graphics::DeleteTexture(spriteComponents[spriteComponentIndices[entity]].tex);
+	if (!spriteComponents.Contains(entity))
+		return;
 
-	spriteComponents[spriteComponentIndices[entity]] = spriteComponents[spriteComponentCount - 1];
-	spriteComponentIndices[spriteComponents[spriteComponentCount - 1].id] = spriteComponentIndices[entity];
+	Graphics::DeleteTexture(spriteComponents.Get(entity).tex);
 
-	spriteComponentIndices.erase(entity);
-	spriteComponentCount--;
+	size_t index = spriteComponents.Erase(entity);
+	size_t last = spriteComponents.Size();
+	minFilters[index] = minFilters[last];
+	magFilters[index] = magFilters[last];
+	mipModes[index] = mipModes[last];
+}
+
+void Renderer2D::DeleteSpriteComponents(const EntityID* entities, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (spriteComponents.Contains(entities[i]))
+		{
+			Graphics::DeleteTexture(spriteComponents.Get(entities[i]).tex);
+		}
+	}
+
+	spriteComponents.EraseBatch(entities, count, [](size_t from, size_t to)
+	{
+		minFilters[to] = minFilters[from];
+		magFilters[to] = magFilters[from];
+		mipModes[to] = mipModes[from];
+	});
 }
 
 std::vector<EntityID> Renderer2D::GetEntitiesWithSpriteComponents()
 {
 	std::vector<EntityID> returnVal;
-	for (size_t i = 0; i < spriteComponentCount; i++)
+	returnVal.reserve(spriteComponents.Size());
+	for (size_t i = 0; i < spriteComponents.Size(); i++)
 	{
-		returnVal.push_back(spriteComponents[i].id);
+		returnVal.push_back(spriteComponents.EntityAt(i));
 	}
 	return returnVal;
 }
 
+bool Renderer2D::HasSpriteComponent(EntityID entity)
+{
+	return spriteComponents.Contains(entity);
+}
+
 
 bool Renderer2D::SerializeSpriteComponent(EntityID entity, YAML::Node& yamlOut)
 {
-	if (spriteComponentIndices.count(entity))
+	if (spriteComponents.Contains(entity))
 	{
-		SpriteComponent& component = spriteComponents[spriteComponentIndices[entity]];
+		size_t index = spriteComponents.IndexOf(entity);
+		SpriteComponent& component = spriteComponents.ValueAt(index);
 		
 		yamlOut["Path"] = HN_ToStr(Graphics::GetTextureHashedPath(component.tex));
 		yamlOut["UVs"]["l"] = component.uv_bounds[0];
 		yamlOut["UVs"]["r"] = component.uv_bounds[1];
 		yamlOut["UVs"]["b"] = component.uv_bounds[2];
 		yamlOut["UVs"]["t"] = component.uv_bounds[3];
-		yamlOut["MinFilter"] = texFilterToStr(minFilters[spriteComponentIndices[entity]]);
-		yamlOut["MagFilter"] = texFilterToStr(magFilters[spriteComponentIndices[entity]]);
-		yamlOut["MipMode"] = mipModeToStr(mipModes[spriteComponentIndices[entity]]);
+		yamlOut["MinFilter"] = texFilterToStr(minFilters[index]);
+		yamlOut["MagFilter"] = texFilterToStr(magFilters[index]);
+		yamlOut["MipMode"] = mipModeToStr(mipModes[index]);
 		return true;
 	}
 	else
@@ -248,8 +299,17 @@ bool Renderer2D::SerializeSpriteComponent(EntityID entity, YAML::Node& yamlOut)
 
 bool Renderer2D::DeserializeSpriteComponent(EntityID entity, const YAML::Node& yamlIn)
 {
-	if (spriteComponentCount < spriteComponents.size())
+	if (spriteComponents.Contains(entity))
 	{
+		EP_ERROR("Renderer2D::DeserializeSpriteComponent(): Entity {} already has a sprite component!", entity);
+		return false;
+	}
+
+	if (spriteComponents.Size() < maxSpriteComponents)
+	{
+		SpriteComponent component;
+		size_t index = spriteComponents.Size();
+
 		if (yamlIn.Type() == YAML::NodeType::Map)
 		{
 			if (yamlIn["Path"] && yamlIn["UVs"] && yamlIn["MinFilter"] && yamlIn["MagFilter"] && yamlIn["MipMode"])
@@ -263,10 +323,10 @@ bool Renderer2D::DeserializeSpriteComponent(EntityID entity, const YAML::Node& y
 					{
 						try
 						{
-							spriteComponents[spriteComponentCount].uv_bounds[0] = yamlIn["UVs"]["l"].as<float>();
-							spriteComponents[spriteComponentCount].uv_bounds[1] = yamlIn["UVs"]["r"].as<float>();
-							spriteComponents[spriteComponentCount].uv_bounds[2] = yamlIn["UVs"]["b"].as<float>();
-							spriteComponents[spriteComponentCount].uv_bounds[3] = yamlIn["UVs"]["t"].as<float>();
+							component.uv_bounds[0] = yamlIn["UVs"]["l"].as<float>();
+							component.uv_bounds[1] = yamlIn["UVs"]["r"].as<float>();
+							component.uv_bounds[2] = yamlIn["UVs"]["b"].as<float>();
+							component.uv_bounds[3] = yamlIn["UVs"]["t"].as<float>();
 						}
 						catch (YAML::BadConversion)
 						{
@@ -275,18 +335,18 @@ bool Renderer2D::DeserializeSpriteComponent(EntityID entity, const YAML::Node& y
 							return false;
 						}
 
-						minFilters[spriteComponentCount] = strToTexFilter(yamlIn["MinFilter"].as<std::string>());
-						magFilters[spriteComponentCount] = strToTexFilter(yamlIn["MagFilter"].as<std::string>());
-						mipModes[spriteComponentCount] = strToMipMode(yamlIn["MipMode"].as<std::string>());
+						minFilters[index] = strToTexFilter(yamlIn["MinFilter"].as<std::string>());
+						magFilters[index] = strToTexFilter(yamlIn["MagFilter"].as<std::string>());
+						mipModes[index] = strToMipMode(yamlIn["MipMode"].as<std::string>());
 
-						spriteComponents[spriteComponentCount].tex =
+						component.tex =
 							Graphics::LoadTexture(
 								yamlIn["Path"].as<std::string>(),
-								minFilters[spriteComponentCount],
-								magFilters[spriteComponentCount],
-								mipModes[spriteComponentCount]);
+								minFilters[index],
+								magFilters[index],
+								mipModes[index]);
 
-						if (spriteComponents[spriteComponentCount].tex == 0)
+						if (component.tex == 0)
 						{
 
 							EP_ERROR("Renderer2D::DeserializeSpriteComponent(): Texture \"{}\" could not be loaded.  "
@@ -294,9 +354,7 @@ bool Renderer2D::DeserializeSpriteComponent(EntityID entity, const YAML::Node& y
 							return false;
 						}
 
-						spriteComponents[spriteComponentCount].id = entity;
-						spriteComponentIndices[entity] = spriteComponentCount;
-						spriteComponentCount++;
+						spriteComponents.Insert(entity, component);
 						return true;
 					}
 					else
@@ -333,3 +391,171 @@ bool Renderer2D::DeserializeSpriteComponent(EntityID entity, const YAML::Node& y
 		return false;
 	}
 }
+
+
+// Binary sprite component layout: a SpriteBinaryData followed by the texture path
+struct SpriteBinaryData
+{
+	float uv_bounds[4];
+	uint32_t minFilter;
+	uint32_t magFilter;
+	uint32_t mipMode;
+	uint32_t pathLength;
+};
+
+bool Renderer2D::SerializeSpriteComponentBinary(EntityID entity, std::vector<uint8_t>& outData)
+{
+	if (spriteComponents.Contains(entity))
+	{
+		size_t index = spriteComponents.IndexOf(entity);
+		const SpriteComponent& component = spriteComponents.ValueAt(index);
+		std::string path = HN_ToStr(Graphics::GetTextureHashedPath(component.tex));
+
+		SpriteBinaryData spriteData;
+		std::copy(std::begin(component.uv_bounds), std::end(component.uv_bounds), spriteData.uv_bounds);
+		spriteData.minFilter = uint32_t(minFilters[index]);
+		spriteData.magFilter = uint32_t(magFilters[index]);
+		spriteData.mipMode = uint32_t(mipModes[index]);
+		spriteData.pathLength = uint32_t(path.size());
+
+		const uint8_t* spriteDataBytes = reinterpret_cast<const uint8_t*>(&spriteData);
+		outData.insert(outData.end(), spriteDataBytes, spriteDataBytes + sizeof(SpriteBinaryData));
+		outData.insert(outData.end(), path.begin(), path.end());
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+bool Renderer2D::DeserializeSpriteComponentBinary(EntityID entity, const uint8_t* data, size_t size)
+{
+	if (spriteComponents.Contains(entity))
+	{
+		EP_ERROR("Renderer2D::DeserializeSpriteComponentBinary(): Entity {} already has a sprite component!", entity);
+		return false;
+	}
+	if (spriteComponents.Size() >= maxSpriteComponents)
+	{
+		EP_ERROR("Renderer2D::DeserializeSpriteComponentBinary(): Exhausted sprite component buffers!");
+		return false;
+	}
+
+	SpriteBinaryData spriteData;
+	if (size < sizeof(SpriteBinaryData))
+	{
+		EP_ERROR("Renderer2D::DeserializeSpriteComponentBinary(): Sprite component data is truncated!  "
+			"Sprite component will not be loaded.  Entity: {}", entity);
+		return false;
+	}
+	std::memcpy(&spriteData, data, sizeof(SpriteBinaryData));
+
+	if (spriteData.pathLength != size - sizeof(SpriteBinaryData) ||
+		spriteData.minFilter > uint32_t(TextureFilter::Linear) ||
+		spriteData.magFilter > uint32_t(TextureFilter::Linear) ||
+		spriteData.mipMode > uint32_t(MipmapMode::Linear))
+	{
+		EP_ERROR("Renderer2D::DeserializeSpriteComponentBinary(): Sprite component data is corrupt!  "
+			"Sprite component will not be loaded.  Entity: {}", entity);
+		return false;
+	}
+
+	SpriteComponent component;
+	size_t index = spriteComponents.Size();
+	std::copy(std::begin(spriteData.uv_bounds), std::end(spriteData.uv_bounds), component.uv_bounds);
+	minFilters[index] = TextureFilter(spriteData.minFilter);
+	magFilters[index] = TextureFilter(spriteData.magFilter);
+	mipModes[index] = MipmapMode(spriteData.mipMode);
+
+	std::string path(reinterpret_cast<const char*>(data + sizeof(SpriteBinaryData)), spriteData.pathLength);
+	component.tex = Graphics::LoadTexture(path, minFilters[index], magFilters[index], mipModes[index]);
+	if (component.tex == 0)
+	{
+		EP_ERROR("Renderer2D::DeserializeSpriteComponentBinary(): Texture \"{}\" could not be loaded.  "
+			"Sprite component will not be attached.  Entity: {}", path, entity);
+		return false;
+	}
+
+	spriteComponents.Insert(entity, component);
+	return true;
+}
+
+
+// Sprite snapshots hold the distinct textures they retain, followed by the sprite pool and filter arrays.
+static std::vector<Graphics::TextureHandle> snapshotTextureScratch;
+
+void Renderer2D::SaveSpriteSnapshot(std::vector<uint8_t>& outData)
+{
+	// Retain each distinct texture once, so it outlives any sprites deleted before the snapshot is restored
+	snapshotTextureScratch.clear();
+	for (size_t i = 0; i < spriteComponents.Size(); i++)
+	{
+		snapshotTextureScratch.push_back(spriteComponents.ValueAt(i).tex);
+	}
+	std::sort(snapshotTextureScratch.begin(), snapshotTextureScratch.end());
+	snapshotTextureScratch.erase(std::unique(snapshotTextureScratch.begin(), snapshotTextureScratch.end()),
+		snapshotTextureScratch.end());
+	for (Graphics::TextureHandle texture : snapshotTextureScratch)
+	{
+		Graphics::RetainTexture(texture);
+	}
+
+	uint64_t textureCount = snapshotTextureScratch.size();
+	const uint8_t* countBytes = reinterpret_cast<const uint8_t*>(&textureCount);
+	const uint8_t* textureBytes = reinterpret_cast<const uint8_t*>(snapshotTextureScratch.data());
+	outData.insert(outData.end(), countBytes, countBytes + sizeof(textureCount));
+	outData.insert(outData.end(), textureBytes, textureBytes + textureCount * sizeof(Graphics::TextureHandle));
+
+	spriteComponents.AppendBytes(outData);
+
+	size_t count = spriteComponents.Size();
+	const uint8_t* minFilterBytes = reinterpret_cast<const uint8_t*>(minFilters.data());
+	const uint8_t* magFilterBytes = reinterpret_cast<const uint8_t*>(magFilters.data());
+	const uint8_t* mipModeBytes = reinterpret_cast<const uint8_t*>(mipModes.data());
+	outData.insert(outData.end(), minFilterBytes, minFilterBytes + count * sizeof(TextureFilter));
+	outData.insert(outData.end(), magFilterBytes, magFilterBytes + count * sizeof(TextureFilter));
+	outData.insert(outData.end(), mipModeBytes, mipModeBytes + count * sizeof(MipmapMode));
+}
+
+void Renderer2D::RestoreSpriteSnapshot(const uint8_t* data, size_t size)
+{
+	uint64_t textureCount;
+	std::memcpy(&textureCount, data, sizeof(textureCount));
+	const uint8_t* cursor = data + sizeof(textureCount) + textureCount * sizeof(Graphics::TextureHandle);
+
+	// The replaced sprites release their textures, and the restored sprites take over references of their own
+	for (size_t i = 0; i < spriteComponents.Size(); i++)
+	{
+		Graphics::DeleteTexture(spriteComponents.ValueAt(i).tex);
+	}
+	cursor = spriteComponents.AssignBytes(cursor);
+	for (size_t i = 0; i < spriteComponents.Size(); i++)
+	{
+		Graphics::RetainTexture(spriteComponents.ValueAt(i).tex);
+	}
+
+	size_t count = spriteComponents.Size();
+	EP_ASSERT(count <= maxSpriteComponents);
+	std::memcpy(minFilters.data(), cursor, count * sizeof(TextureFilter));
+	cursor += count * sizeof(TextureFilter);
+	std::memcpy(magFilters.data(), cursor, count * sizeof(TextureFilter));
+	cursor += count * sizeof(TextureFilter);
+	std::memcpy(mipModes.data(), cursor, count * sizeof(MipmapMode));
+	cursor += count * sizeof(MipmapMode);
+	EP_ASSERT(cursor == data + size);
+}
+
+void Renderer2D::ReleaseSpriteSnapshot(const uint8_t* data, size_t size)
+{
+	uint64_t textureCount;
+	std::memcpy(&textureCount, data, sizeof(textureCount));
+	EP_ASSERT(sizeof(textureCount) + textureCount * sizeof(Graphics::TextureHandle) <= size);
+
+	for (size_t i = 0; i < textureCount; i++)
+	{
+		Graphics::TextureHandle texture;
+		std::memcpy(&texture, data + sizeof(textureCount) + i * sizeof(Graphics::TextureHandle), sizeof(texture));
+		Graphics::DeleteTexture(texture);
+	}
+}
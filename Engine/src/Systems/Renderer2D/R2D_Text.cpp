@@ -3,12 +3,13 @@
 using namespace Enterprise;
 
 constexpr double tabWidthInEms = 2.0;
+HN_CONSTANT(textAtlasUniform, "in_tex");
 
 void Renderer2D::DrawText(std::string text, Graphics::TextureHandle atlas,
 	glm::vec3 position, glm::quat rotation, float size,
 	TextAlignment alignment)
 {
-	Graphics::BindTexture(atlas, HN("in_tex"));
+	Graphics::BindTexture(atlas, textAtlasUniform);
 	Graphics::SetModelMatrix(glm::mat4(1.0f));
 
 	size_t lineCount = 1;
@@ -82,7 +83,7 @@ void Renderer2D::DrawText(std::string text, Graphics::TextureHandle atlas,
 
 	for (const char& c : text)
 	{
-		if (currentQuadIndex >= spriteComponents.size())
+		if (currentQuadIndex >= maxSpriteComponents)
 		{
 			Graphics::SetVertexData(quadVAH, quadVertices.data(), 0, currentQuadIndex * 4);
 			Graphics::DrawTriangles(quadVAH, currentQuadIndex * 6, 0);
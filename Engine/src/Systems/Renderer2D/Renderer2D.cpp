@@ -8,19 +8,32 @@ Graphics::VertexArrayHandle Renderer2D::quadVAH;
 
 void Renderer2D::Init(size_t maxSpriteComponents)
 {
-	spriteComponents.resize(maxSpriteComponents);
+	Renderer2D::maxSpriteComponents = maxSpriteComponents;
+	spriteComponents.Reserve(maxSpriteComponents);
 	minFilters.resize(maxSpriteComponents);
 	magFilters.resize(maxSpriteComponents);
 	mipModes.resize(maxSpriteComponents);
 	quadVertices.resize(4 * maxSpriteComponents);
 
-	SceneManager::RegisterSceneDrawFn(SceneDraw);
+	SceneManager::RegisterSceneDrawFn(SceneDraw, "Renderer2D::SceneDraw");
 	SceneManager::RegisterComponentType(
 		HN("Sprite"),
 		DeleteSpriteComponent,
 		GetEntitiesWithSpriteComponents,
 		SerializeSpriteComponent,
 		DeserializeSpriteComponent);
+	SceneManager::RegisterBatchDeleter(HN("Sprite"), DeleteSpriteComponents);
+	SceneManager::RegisterComponentCheck(HN("Sprite"), HasSpriteComponent);
+	SceneManager::RegisterBinarySerializers(
+		HN("Sprite"),
+		SerializeSpriteComponentBinary,
+		DeserializeSpriteComponentBinary);
+	SceneManager::RegisterSnapshotFns(
+		HN("Sprite"),
+		SaveSpriteSnapshot,
+		RestoreSpriteSnapshot,
+		ReleaseSpriteSnapshot);
+	SceneManager::RegisterComponentPool(spriteComponents);
 
 	//Editor::RegisterComponentInspector(
 	//	HN("Sprite"),
@@ -1,15 +1,41 @@
+#include <yaml-cpp/yaml.h>
 #include "Enterprise/Time.h"
 #include "Enterprise/Graphics.h"
+#include "Enterprise/File.h"
 
 using Enterprise::Time;
+using Enterprise::FixedCatchUpPolicy;
 
-static uint64_t fixedTimestepInRealTicks;
+static uint64_t fixedTimestepInRealTicks, fixedTimestepInGameTicks;
 #ifdef EP_CONFIG_RELEASE
-static uint64_t fixedTimestepInGameTicks, maxFrameDeltaInRealTicks;
+static uint64_t maxFrameDeltaInRealTicks;
 #endif
 
+// Catch-up policy
+static double fixedTimestep = Enterprise::Constants::Time::FixedTimestep;
+static unsigned int maxFixedSubsteps = Enterprise::Constants::Time::DefaultMaxFixedSubsteps;
+static FixedCatchUpPolicy catchUpPolicy = FixedCatchUpPolicy::Drop;
+static double maxTimeDebt = Enterprise::Constants::Time::DefaultMaxTimeDebt;
+static bool variableFixedTimestep = false;
+static double maxFixedTimestep = Enterprise::Constants::Time::DefaultMaxFixedTimestep;
+static unsigned int idleFrames = 0; // Consecutive frames in which fixed updates used little of the frame
+
+// Fixed update statistics
+static unsigned int stepsThisFrame = 0;
+static uint64_t fixedStepsStartTicks;
+static uint64_t totalFixedSteps = 0, throttledFrames = 0;
+static uint64_t droppedGameTicks = 0;
+static unsigned int stepsLastFrame_out = 0;
+
 static double currentTimeScale = 1.0;
 
+// Frame timing, recorded and replayed by event traces
+static uint64_t frameCount = 0;
+static double frameFixedTimestep = Enterprise::Constants::Time::FixedTimestep;
+static bool replayFramePending = false, replayingFrame = false;
+static uint64_t replayFrameTicks;
+static double replayFixedTimestep;
+
 static uint64_t currentSysTimeInTicks = 0, previousSysTimeInTicks;
 static uint64_t measuredRealTickDelta, measuredGameTickDelta;
 static uint64_t realRunningTicks = 0, gameRunningTicks = 0;
@@ -40,6 +66,25 @@ float Time::GameDelta() { return gameDelta_out; }
 float Time::RealRemainder() { return unsimmedRealTime_out; }
 float Time::GameRemainder() { return unsimmedGameTime_out; }
 float Time::FixedFrameInterp() { return fixedFrameInterp_out; }
+float Time::FixedTimestep() { return float(fixedTimestep); }
+uint64_t Time::FrameCount() { return frameCount; }
+uint64_t Time::FrameTicks() { return measuredRealTickDelta; }
+double Time::FrameFixedTimestep() { return frameFixedTimestep; }
+
+void Time::SetReplayFrame(uint64_t realTicks, double timestep)
+{
+	// Consumed by the next Update()
+	replayFramePending = true;
+	replayFrameTicks = realTicks;
+	replayFixedTimestep = timestep;
+}
+
+void Time::UpdateFixedTimestepTicks()
+	// Helper function: recalculates the cached length of the fixed timestep.
+{
+	fixedTimestepInRealTicks = SecondsToTicks(fixedTimestep / currentTimeScale);
+	fixedTimestepInGameTicks = SecondsToTicks(fixedTimestep);
+}
 
 void Time::SetTimeScale(double scalar)
 {
@@ -53,7 +98,124 @@ void Time::SetTimeScale(double scalar)
 		currentTimeScale = 0.0f;
 	}
 
-	fixedTimestepInRealTicks = SecondsToTicks(Constants::Time::FixedTimestep / currentTimeScale);
+	UpdateFixedTimestepTicks();
+}
+
+void Time::SetMaxFixedSubsteps(unsigned int maxSubsteps)
+{
+	if (maxSubsteps >= 1)
+	{
+		maxFixedSubsteps = maxSubsteps;
+	}
+	else
+	{
+		EP_WARN("Time::SetMaxFixedSubsteps(): 'maxSubsteps' set to 0.  Set to 1 instead.");
+		maxFixedSubsteps = 1;
+	}
+}
+
+void Time::SetFixedCatchUpPolicy(FixedCatchUpPolicy policy, double maxDebt)
+{
+	catchUpPolicy = policy;
+	if (maxDebt >= 0.0)
+	{
+		maxTimeDebt = maxDebt;
+	}
+	else
+	{
+		EP_WARN("Time::SetFixedCatchUpPolicy(): 'maxTimeDebt' set to negative value.  Set to 0.0 instead.");
+		maxTimeDebt = 0.0;
+	}
+}
+
+void Time::SetVariableFixedTimestep(bool enabled, double maxTimestep)
+{
+	variableFixedTimestep = enabled;
+	if (maxTimestep >= Constants::Time::FixedTimestep)
+	{
+		maxFixedTimestep = maxTimestep;
+	}
+	else
+	{
+		EP_WARN("Time::SetVariableFixedTimestep(): 'maxTimestep' is shorter than Constants::Time::FixedTimestep.  "
+			"Set to Constants::Time::FixedTimestep instead.");
+		maxFixedTimestep = Constants::Time::FixedTimestep;
+	}
+
+	if (!enabled && fixedTimestep != Constants::Time::FixedTimestep)
+	{
+		fixedTimestep = Constants::Time::FixedTimestep;
+		UpdateFixedTimestepTicks();
+	}
+}
+
+Time::FixedUpdateStats Time::GetFixedUpdateStats()
+{
+	return
+	{
+		totalFixedSteps,
+		stepsLastFrame_out,
+		throttledFrames,
+		double(TicksToSeconds(droppedGameTicks)),
+		double(unsimmedGameTime_out),
+		fixedTimestep
+	};
+}
+
+static void readProjectTimeSettings()
+	// Helper function: applies the "Time" section of the project file.
+{
+	if (!Enterprise::Runtime::CheckCmdLineOption(HN("--project")))
+		return;
+
+	std::vector<std::string> projectOptionArgs = Enterprise::Runtime::GetCmdLineOption(HN("--project"));
+	std::string projectFileContents;
+	if (projectOptionArgs.empty() ||
+		Enterprise::File::LoadTextFile(projectOptionArgs.front(), &projectFileContents) !=
+			Enterprise::File::ErrorCode::Success)
+		return;
+
+	try
+	{
+		YAML::Node yamlIn = YAML::Load(projectFileContents);
+		if (yamlIn.Type() != YAML::NodeType::Map || !yamlIn["Time"])
+			return;
+
+		YAML::Node timeNode = yamlIn["Time"];
+		if (timeNode["MaxFixedSubsteps"])
+		{
+			Time::SetMaxFixedSubsteps(timeNode["MaxFixedSubsteps"].as<unsigned int>());
+		}
+		if (timeNode["FixedCatchUp"])
+		{
+			std::string policyName = timeNode["FixedCatchUp"].as<std::string>();
+			double debt = timeNode["MaxTimeDebt"] ?
+				timeNode["MaxTimeDebt"].as<double>() : Enterprise::Constants::Time::DefaultMaxTimeDebt;
+			if (policyName == "CarryOver")
+			{
+				Time::SetFixedCatchUpPolicy(FixedCatchUpPolicy::CarryOver, debt);
+			}
+			else if (policyName == "Drop")
+			{
+				Time::SetFixedCatchUpPolicy(FixedCatchUpPolicy::Drop, debt);
+			}
+			else
+			{
+				EP_ERROR("Time::Init(): Unknown \"FixedCatchUp\" policy \"{}\".  Default will be used.", policyName);
+			}
+		}
+		if (timeNode["VariableFixedTimestep"])
+		{
+			Time::SetVariableFixedTimestep(timeNode["VariableFixedTimestep"].as<bool>(),
+				timeNode["MaxFixedTimestep"] ?
+					timeNode["MaxFixedTimestep"].as<double>() : Enterprise::Constants::Time::DefaultMaxFixedTimestep);
+		}
+	}
+	catch (const YAML::Exception& e)
+	{
+		EP_ERROR("Time::Init(): YAML exception while reading project file!  Default fixed update settings will be "
+			"used.  Message: {}", e.msg);
+	}
 }
 
 void Time::Init()
@@ -62,9 +224,9 @@ void Time::Init()
 
 #ifdef EP_CONFIG_RELEASE
 	maxFrameDeltaInRealTicks = SecondsToTicks(Constants::Time::MaxFrameDelta / currentTimeScale);
-	fixedTimestepInRealTicks = SecondsToTicks(Constants::Time::FixedTimestep / currentTimeScale);
-	fixedTimestepInGameTicks = SecondsToTicks(Constants::Time::FixedTimestep);
 #endif
+	UpdateFixedTimestepTicks();
+	readProjectTimeSettings();
 
 	timeGlobalUB = Graphics::CreateUniformBuffer(HN("EP_TIME"), sizeof(timeGlobalUBStruct));
 }
@@ -75,21 +237,72 @@ void Time::Cleanup()
 }
 
 
+void Time::ApplyCatchUpPolicy()
+	// Helper function: discards unsimulated time beyond what the catch-up policy allows.
+{
+	uint64_t allowedTicks = fixedTimestepInGameTicks - 1; // Less than one step, so interpolation stays in [0, 1)
+	if (catchUpPolicy == FixedCatchUpPolicy::CarryOver)
+	{
+		allowedTicks = std::max(allowedTicks, SecondsToTicks(maxTimeDebt));
+	}
+
+	if (unsimmedGameTicks > allowedTicks)
+	{
+		uint64_t droppedTicks = unsimmedGameTicks - allowedTicks;
+		uint64_t droppedRealTicks = std::min(unsimmedRealTicks,
+			currentTimeScale > 0.0 ? uint64_t(droppedTicks / currentTimeScale) : unsimmedRealTicks);
+
+		// Dropped time never happened, as far as the game is concerned
+		droppedGameTicks += droppedTicks;
+		unsimmedGameTicks -= droppedTicks;
+		gameRunningTicks -= droppedTicks;
+		unsimmedRealTicks -= droppedRealTicks;
+		realRunningTicks -= droppedRealTicks;
+	}
+}
+
+void Time::AdaptFixedTimestep(bool throttled)
+	// Helper function: lengthens the fixed timestep under load, and shortens it again once the load has passed.
+{
+	constexpr unsigned int idleFramesBeforeShortening = 60;
+
+	if (throttled)
+	{
+		idleFrames = 0;
+		if (fixedTimestep * 2.0 <= maxFixedTimestep)
+		{
+			fixedTimestep *= 2.0;
+			UpdateFixedTimestepTicks();
+		}
+		return;
+	}
+
+	// Halving the timestep doubles the cost of fixed updates, so only do it if they would still fit comfortably
+	uint64_t fixedCostTicks = GetRawTicks() - fixedStepsStartTicks;
+	if (fixedTimestep > Constants::Time::FixedTimestep && fixedCostTicks * 4 < measuredRealTickDelta)
+	{
+		if (++idleFrames >= idleFramesBeforeShortening)
+		{
+			idleFrames = 0;
+			fixedTimestep = std::max(fixedTimestep / 2.0, Constants::Time::FixedTimestep);
+			UpdateFixedTimestepTicks();
+		}
+	}
+	else
+	{
+		idleFrames = 0;
+	}
+}
+
 bool Time::ProcessFixedUpdate()
 {
-#ifdef EP_CONFIG_RELEASE
-	if (unsimmedGameTicks >= fixedTimestepInGameTicks)
+	if (unsimmedGameTicks >= fixedTimestepInGameTicks && stepsThisFrame < maxFixedSubsteps)
 	{
 		// Going to FixedUpdate()
-		unsimmedRealTicks -= fixedTimestepInRealTicks;
+		unsimmedRealTicks -= std::min(unsimmedRealTicks, fixedTimestepInRealTicks);
 		unsimmedGameTicks -= fixedTimestepInGameTicks;
-#else
-	if (unsimmedGameTicks >= SecondsToTicks(Constants::Time::FixedTimestep))
-	{
-		// Going to FixedUpdate()
-		unsimmedRealTicks -= SecondsToTicks(Constants::Time::FixedTimestep / currentTimeScale);
-		unsimmedGameTicks -= SecondsToTicks(Constants::Time::FixedTimestep);
-#endif
+		stepsThisFrame++;
+		totalFixedSteps++;
 
 		realRunningTime_out = TicksToSeconds(realRunningTicks - unsimmedRealTicks);
 		gameRunningTime_out = TicksToSeconds(gameRunningTicks - unsimmedGameTicks);
@@ -99,6 +312,18 @@ bool Time::ProcessFixedUpdate()
 	else
 	{
 		// Going to Update()
+		bool throttled = unsimmedGameTicks >= fixedTimestepInGameTicks;
+		if (throttled)
+		{
+			throttledFrames++;
+			ApplyCatchUpPolicy();
+		}
+		if (variableFixedTimestep && !replayingFrame)
+		{
+			AdaptFixedTimestep(throttled);
+		}
+		stepsLastFrame_out = stepsThisFrame;
+
 		inFixedTimestep_out = false;
 
 		realRunningTime_out = TicksToSeconds(realRunningTicks);
@@ -110,11 +335,9 @@ bool Time::ProcessFixedUpdate()
 		unsimmedRealTime_out = TicksToSeconds(unsimmedRealTicks);
 		unsimmedGameTime_out = TicksToSeconds(unsimmedGameTicks);
 
-#ifdef EP_CONFIG_RELEASE
-		fixedFrameInterp_out = double(unsimmedGameTicks) / double(fixedTimestepInGameTicks);
-#else
-		fixedFrameInterp_out = TicksToSeconds(unsimmedGameTicks) / Constants::Time::FixedTimestep;
-#endif
+		// Carried-over time can exceed a full step, but the next step has not been simulated yet
+		fixedFrameInterp_out = std::min(float(double(unsimmedGameTicks) / double(fixedTimestepInGameTicks)),
+			std::nextafter(1.0f, 0.0f));
 
 		return false;
 	}
@@ -124,12 +347,29 @@ void Time::Update()
 {
 	previousSysTimeInTicks = currentSysTimeInTicks;
 	currentSysTimeInTicks = GetRawTicks();
+	frameCount++;
 
+	replayingFrame = replayFramePending;
+	if (replayFramePending)
+	{
+		// Replayed frames take the length and fixed timestep of the recorded frame, so they simulate identically
+		replayFramePending = false;
+		measuredRealTickDelta = replayFrameTicks;
+		if (fixedTimestep != replayFixedTimestep)
+		{
+			fixedTimestep = replayFixedTimestep;
+			UpdateFixedTimestepTicks();
+		}
+	}
+	else
+	{
 #ifdef EP_CONFIG_RELEASE
-	measuredRealTickDelta = std::min(currentSysTimeInTicks - previousSysTimeInTicks, maxFrameDeltaInRealTicks);
+		measuredRealTickDelta = std::min(currentSysTimeInTicks - previousSysTimeInTicks, maxFrameDeltaInRealTicks);
 #else
-	measuredRealTickDelta = std::min(currentSysTimeInTicks - previousSysTimeInTicks, SecondsToTicks(Constants::Time::MaxFrameDelta / currentTimeScale));
+		measuredRealTickDelta = std::min(currentSysTimeInTicks - previousSysTimeInTicks, SecondsToTicks(Constants::Time::MaxFrameDelta / currentTimeScale));
 #endif
+	}
+	frameFixedTimestep = fixedTimestep;
 	measuredGameTickDelta = measuredRealTickDelta * currentTimeScale;
 
 	realRunningTicks += measuredRealTickDelta;
@@ -140,13 +380,11 @@ void Time::Update()
 
 	// Going to FixedUpdate()
 	inFixedTimestep_out = true;
+	stepsThisFrame = 0;
+	fixedStepsStartTicks = currentSysTimeInTicks;
 
-#ifdef EP_CONFIG_RELEASE
 	realDelta_out = TicksToSeconds(fixedTimestepInRealTicks);
-#else
-	realDelta_out = TicksToSeconds(SecondsToTicks(Constants::Time::FixedTimestep / currentTimeScale));
-#endif
-	gameDelta_out = Constants::Time::FixedTimestep;
+	gameDelta_out = float(fixedTimestep);
 
 	unsimmedRealTime_out = 0.0f;
 	unsimmedGameTime_out = 0.0f;
@@ -186,11 +424,7 @@ void Time::Update()
 
 bool Time::isFixedUpdatePending()
 {
-#ifdef EP_CONFIG_RELEASE
-	return unsimmedGameTicks / fixedTimestepInGameTicks;
-#else
-	return unsimmedGameTicks / SecondsToTicks(Constants::Time::FixedTimestep);
-#endif
+	return unsimmedGameTicks >= fixedTimestepInGameTicks && stepsThisFrame < maxFixedSubsteps;
 }
 
 float Time::ActualRealDelta()